@@ -0,0 +1,557 @@
+/*
+  ==============================================================================
+
+    AccuracyGate.cpp
+    Checks the faster processing paths against a double precision reference.
+
+  ==============================================================================
+*/
+
+#include "AccuracyGate.h"
+#include "AccuracyGateResults.h"
+#include "BatchDesigner.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  the chain again in double precision, RBJ bell and the cut prototypes designed and run in double
+
+static constexpr int fftOrder = 13;
+static constexpr int renderLength = 1 << fftOrder;
+
+struct ReferenceSection
+{
+    double b0 { 1.0 }, b1 { 0.0 }, b2 { 0.0 }, a1 { 0.0 }, a2 { 0.0 };
+    double x1 { 0.0 }, x2 { 0.0 }, y1 { 0.0 }, y2 { 0.0 };
+
+    double processSample(double x)
+    {
+        auto y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        x2 = x1;
+        x1 = x;
+        y2 = y1;
+        y1 = y;
+        return y;
+    }
+};
+
+static ReferenceSection makeBellSection(double frequency, double q, double decibels, double sampleRate)
+{
+    auto w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    auto alpha = std::sin(w) / (2.0 * q);
+    auto cosW = std::cos(w);
+    auto A = std::pow(10.0, decibels / 40.0);
+    auto a0 = 1.0 + alpha / A;
+
+    ReferenceSection section;
+    section.b0 = (1.0 + alpha * A) / a0;
+    section.b1 = -2.0 * cosW / a0;
+    section.b2 = (1.0 - alpha * A) / a0;
+    section.a1 = -2.0 * cosW / a0;
+    section.a2 = (1.0 - alpha / A) / a0;
+
+    return section;
+}
+
+struct ReferenceChain
+{
+    ReferenceChain(const ChainSettings& s, double sampleRate)
+    {
+        auto addCut = [&](double frequency, Slope slope, CutFamily family, bool isHighPass)
+        {
+            auto& prototype = getCutPrototype(family, getCutFilterOrder(slope));
+
+            for( int i = 0; i < prototype.numSections; ++i )
+            {
+                auto c = designCutSection(prototype.sections[(size_t) i], i == 0 ? prototype.gain : 1.0,
+                                          frequency, sampleRate, isHighPass);
+
+                ReferenceSection section;
+                section.b0 = c[0];
+                section.b1 = c[1];
+                section.b2 = c[2];
+                section.a1 = c[4];
+                section.a2 = c[5];
+                sections.push_back(section);
+            }
+        };
+
+        addCut(s.lowCutFreq, s.lowCutSlope, s.lowCutFamily, true);
+        sections.push_back(makeBellSection(s.peakFreq, s.peakQuality, s.peakGainInDecibels, sampleRate));
+        addCut(s.highCutFreq, s.highCutSlope, s.highCutFamily, false);
+    }
+
+    double processSample(double x)
+    {
+        for( auto& section : sections )
+            x = section.processSample(x);
+
+        return x;
+    }
+
+    std::vector<ReferenceSection> sections;
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  parameter defaults, every band but the one under test sits here
+static ChainSettings getNeutralSettings()
+{
+    ChainSettings settings;
+    settings.peakFreq = 750.f;
+    settings.peakGainInDecibels = 0.f;
+    settings.peakQuality = 1.f;
+    settings.lowCutFreq = 20.f;
+    settings.highCutFreq = 20000.f;
+    return settings;
+}
+
+static std::vector<ChainSettings> makeSettingsGrid(double sampleRate)
+{
+    //below fs / 500 a float direct form runs out of precision whatever designs it
+    auto lowest = juce::jmax(20.0, sampleRate / 500.0);
+    auto highest = juce::jmin(20000.0, 0.45 * sampleRate);
+    std::vector<ChainSettings> grid;
+
+    for( int f = 0; f < 4; ++f )
+    {
+        auto frequency = (float) std::round(juce::mapToLog10(f / 3.0, lowest, highest));
+
+        //first order, a middle slope and the steepest, in every family
+        for( int family = CutFamily::Butterworth; family <= CutFamily::Chebyshev; ++family )
+        {
+            for( auto slope : { Slope_6, Slope_24, Slope_96 } )
+            {
+                auto lowCut = getNeutralSettings();
+                lowCut.lowCutFreq = frequency;
+                lowCut.lowCutSlope = slope;
+                lowCut.lowCutFamily = static_cast<CutFamily>(family);
+                grid.push_back(lowCut);
+
+                auto highCut = getNeutralSettings();
+                highCut.highCutFreq = frequency;
+                highCut.highCutSlope = slope;
+                highCut.highCutFamily = static_cast<CutFamily>(family);
+                grid.push_back(highCut);
+            }
+        }
+
+        for( auto gain : { -24.f, 6.f, 24.f } )
+        {
+            for( auto quality : { 0.1f, 1.1f, 9.6f } )
+            {
+                auto peak = getNeutralSettings();
+                peak.peakFreq = frequency;
+                peak.peakGainInDecibels = gain;
+                peak.peakQuality = quality;
+                grid.push_back(peak);
+            }
+        }
+    }
+
+    return grid;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//the cascade loop a path runs its biquad chains on
+static FilterKernels::Variant getKernel(AccuracyGate::Path path)
+{
+    switch( path )
+    {
+        case AccuracyGate::Avx2KernelPath:   return FilterKernels::Avx2;
+        case AccuracyGate::Avx512KernelPath: return FilterKernels::Avx512;
+        default:                             return FilterKernels::Generic;
+    }
+}
+
+//every path runs a stereo pair in place from cleared state, only the processing is timed
+static void renderPath(AccuracyGate::Path path, const ChainSettings& settings, double sampleRate,
+                       float* left, float* right, int numSamples, juce::int64& ticks)
+{
+    juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) numSamples, 1 };
+
+    if( path == AccuracyGate::SvfPath )
+    {
+        SvfChain leftSvf, rightSvf;
+
+        for( auto* svf : { &leftSvf, &rightSvf } )
+        {
+            svf->prepare(sampleRate);
+            svf->setTargets(settings);
+            svf->reset();
+        }
+
+        auto start = juce::Time::getHighResolutionTicks();
+        leftSvf.process(left, numSamples);
+        rightSvf.process(right, numSamples);
+        ticks += juce::Time::getHighResolutionTicks() - start;
+        return;
+    }
+
+    MonoChain leftChain, rightChain;
+    leftChain.prepare(spec);
+    rightChain.prepare(spec);
+
+    if( path == AccuracyGate::MidSidePath || path == AccuracyGate::FusedMidSidePath )
+    {
+        //mid gets the settings under test, side stays neutral so the two differ
+        auto neutral = getNeutralSettings();
+        setChainCoefficients(leftChain, makeChainCoefficients(settings, sampleRate));
+        setChainCoefficients(rightChain, makeChainCoefficients(neutral, sampleRate));
+
+        auto start = juce::Time::getHighResolutionTicks();
+
+        if( path == AccuracyGate::FusedMidSidePath )
+            processMidSideFused(leftChain, rightChain, left, right, numSamples);
+        else
+            processMidSideSeparately(leftChain, rightChain, left, right, numSamples);
+
+        ticks += juce::Time::getHighResolutionTicks() - start;
+        return;
+    }
+
+    ChainCoefficients coefficients;
+
+    if( path == AccuracyGate::BatchDesignedPath )
+    {
+        BatchDesigner designer;
+        designer.design(&settings, &coefficients, 1, sampleRate);
+    }
+    else
+    {
+        coefficients = makeChainCoefficients(settings, sampleRate);
+    }
+
+    setChainCoefficients(leftChain, coefficients);
+    setChainCoefficients(rightChain, coefficients);
+
+    //the pair goes through the path's kernel together, as it would in the plugin
+    auto kernel = FilterKernels::getKernel(getKernel(path));
+    FilterKernels::Lane lanes[] = { leftChain.makeLane(left), rightChain.makeLane(right) };
+
+    auto start = juce::Time::getHighResolutionTicks();
+    kernel(lanes, 2, numSamples);
+    ticks += juce::Time::getHighResolutionTicks() - start;
+}
+
+static void renderReference(const ChainSettings& settings, double sampleRate, bool isMidSide,
+                            const float* leftInput, const float* rightInput, double* left, double* right, int numSamples)
+{
+    ReferenceChain first(settings, sampleRate);
+    ReferenceChain second(isMidSide ? getNeutralSettings() : settings, sampleRate);
+
+    for( int i = 0; i < numSamples; ++i )
+    {
+        double l = leftInput[i], r = rightInput[i];
+
+        if( ! isMidSide )
+        {
+            left[i] = first.processSample(l);
+            right[i] = second.processSample(r);
+            continue;
+        }
+
+        auto mid = first.processSample((l + r) * 0.5);
+        auto side = second.processSample((l - r) * 0.5);
+        left[i] = mid + side;
+        right[i] = mid - side;
+    }
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+static void compareImpulseResponses(juce::dsp::FFT& fft, const std::vector<double>& reference, const std::vector<float>& rendered,
+                                    double sampleRate, AccuracyGate::Result& result)
+{
+    std::vector<float> referenceSpectrum((size_t) renderLength * 2, 0.f), renderedSpectrum((size_t) renderLength * 2, 0.f);
+
+    for( size_t i = 0; i < (size_t) renderLength; ++i )
+    {
+        referenceSpectrum[i] = (float) reference[i];
+        renderedSpectrum[i] = rendered[i];
+    }
+
+    fft.performRealOnlyForwardTransform(referenceSpectrum.data(), true);
+    fft.performRealOnlyForwardTransform(renderedSpectrum.data(), true);
+
+    auto highest = juce::jmin(20000.0, 0.45 * sampleRate);
+
+    for( int bin = 1; bin <= renderLength / 2; ++bin )
+    {
+        auto frequency = bin * sampleRate / renderLength;
+
+        if( frequency < 20.0 || frequency > highest )
+            continue;
+
+        std::complex<double> r(referenceSpectrum[(size_t) bin * 2], referenceSpectrum[(size_t) bin * 2 + 1]);
+        std::complex<double> p(renderedSpectrum[(size_t) bin * 2], renderedSpectrum[(size_t) bin * 2 + 1]);
+
+        //a path that blew up fails outright
+        if( ! std::isfinite(p.real()) || ! std::isfinite(p.imag()) )
+        {
+            result.magnitudeErrorDb = result.phaseErrorDegrees = std::numeric_limits<float>::infinity();
+            return;
+        }
+
+        auto referenceDb = juce::Decibels::gainToDecibels(std::abs(r), -200.0);
+
+        if( referenceDb < -60.0 )
+            continue;
+
+        auto renderedDb = juce::Decibels::gainToDecibels(std::abs(p), -200.0);
+        result.magnitudeErrorDb = juce::jmax(result.magnitudeErrorDb, (float) std::abs(renderedDb - referenceDb));
+
+        if( referenceDb > -20.0 )
+            result.phaseErrorDegrees = juce::jmax(result.phaseErrorDegrees, (float) juce::radiansToDegrees(std::abs(std::arg(p / r))));
+    }
+}
+
+static double getErrorRatio(const std::vector<double>& reference, const std::vector<float>& rendered, const std::vector<float>& input)
+{
+    double error = 0.0, signal = 0.0;
+
+    for( size_t i = 0; i < reference.size(); ++i )
+    {
+        auto difference = reference[i] - (double) rendered[i];
+        error += difference * difference;
+        signal += (double) input[i] * (double) input[i];
+    }
+
+    return std::isfinite(error) ? error / juce::jmax(signal, 1.0e-30) : std::numeric_limits<double>::infinity();
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+const char* AccuracyGate::getName(Path path)
+{
+    switch( path )
+    {
+        case ScalarBiquadPath:  return "scalar biquad";
+        case MidSidePath:       return "mid/side";
+        case BatchDesignedPath: return "batch designed";
+        case FusedMidSidePath:  return "fused mid/side";
+        case SvfPath:           return "svf";
+        case Avx2KernelPath:    return "avx2 kernel";
+        case Avx512KernelPath:  return "avx512 kernel";
+        case numPaths:          break;
+    }
+
+    return "";
+}
+
+AccuracyGate::Path AccuracyGate::getFallback(Path path)
+{
+    switch( path )
+    {
+        case FusedMidSidePath:
+        case MidSidePath:       return MidSidePath;
+        case BatchDesignedPath:
+        case SvfPath:
+        case Avx2KernelPath:
+        case Avx512KernelPath:
+        case ScalarBiquadPath:
+        case numPaths:          break;
+    }
+
+    return ScalarBiquadPath;
+}
+
+std::array<AccuracyGate::Result, AccuracyGate::numPaths> AccuracyGate::measure(double sampleRate)
+{
+    //as in processBlock, otherwise the paths that leave their tails denormal longest look slowest
+    juce::ScopedNoDenormals noDenormals;
+
+    std::array<Result, numPaths> results;
+    std::array<juce::int64, numPaths> ticks {};
+    std::array<double, numPaths> worstErrorRatio {};
+
+    auto length = (size_t) renderLength;
+    juce::dsp::FFT fft(fftOrder);
+
+    //noise on the left, a log sweep up to the top of the grid on the right
+    std::vector<float> impulse(length, 0.f), silence(length, 0.f), noise(length), sweep(length);
+    impulse[0] = 1.f;
+
+    juce::Random random(0x5eed);
+    double phase = 0.0;
+
+    for( size_t i = 0; i < length; ++i )
+    {
+        noise[i] = random.nextFloat() - 0.5f;
+        phase += juce::MathConstants<double>::twoPi * juce::mapToLog10((double) i / (double) length, 20.0, 0.45 * sampleRate) / sampleRate;
+        sweep[i] = 0.5f * (float) std::sin(phase);
+    }
+
+    std::vector<double> referenceLeft(length), referenceRight(length);
+    std::vector<float> left(length), right(length);
+
+    for( int p = 0; p < numPaths; ++p )
+        results[(size_t) p].isSupported = FilterKernels::isSupported(getKernel(static_cast<Path>(p)));
+
+    for( auto& settings : makeSettingsGrid(sampleRate) )
+    {
+        for( int p = 0; p < numPaths; ++p )
+        {
+            auto path = static_cast<Path>(p);
+            auto isMidSide = path == MidSidePath || path == FusedMidSidePath;
+            auto& result = results[(size_t) p];
+
+            if( ! result.isSupported )
+                continue;
+
+            //impulse response, left channel
+            left = impulse;
+            right = silence;
+            renderPath(path, settings, sampleRate, left.data(), right.data(), renderLength, ticks[(size_t) p]);
+            renderReference(settings, sampleRate, isMidSide, impulse.data(), silence.data(), referenceLeft.data(), referenceRight.data(), renderLength);
+            compareImpulseResponses(fft, referenceLeft, left, sampleRate, result);
+
+            //program-like material on both channels
+            left = noise;
+            right = sweep;
+            renderPath(path, settings, sampleRate, left.data(), right.data(), renderLength, ticks[(size_t) p]);
+            renderReference(settings, sampleRate, isMidSide, noise.data(), sweep.data(), referenceLeft.data(), referenceRight.data(), renderLength);
+
+            worstErrorRatio[(size_t) p] = juce::jmax(worstErrorRatio[(size_t) p],
+                                                     getErrorRatio(referenceLeft, left, noise),
+                                                     getErrorRatio(referenceRight, right, sweep));
+            ++result.numSettings;
+        }
+    }
+
+    for( size_t p = 0; p < results.size(); ++p )
+    {
+        auto& result = results[p];
+        auto numSamples = (double) result.numSettings * 4.0 * renderLength;
+
+        result.outputErrorDb = (float) juce::Decibels::gainToDecibels(std::sqrt(worstErrorRatio[p]), -200.0);
+        result.nanosecondsPerSample = 1.0e9 * juce::Time::highResolutionTicksToSeconds(ticks[p]) / juce::jmax(1.0, numSamples);
+    }
+
+    //the fallbacks are measured for reference but always stay on
+    for( size_t p = 0; p < results.size(); ++p )
+    {
+        auto& result = results[p];
+        auto fallback = getFallback(static_cast<Path>(p));
+
+        if( fallback == static_cast<Path>(p) )
+            continue;
+
+        auto& baseline = results[(size_t) fallback];
+
+        result.passed = result.isSupported
+                     && result.magnitudeErrorDb <= juce::jmax(magnitudeToleranceDb, baseline.magnitudeErrorDb * 1.1f)
+                     && result.phaseErrorDegrees <= juce::jmax(phaseToleranceDegrees, baseline.phaseErrorDegrees * 1.1f)
+                     && result.outputErrorDb <= juce::jmax(outputToleranceDb, baseline.outputErrorDb + 1.f);
+    }
+
+    //the grid above only has a few settings per family, the designer's own sweep covers the rest
+    auto& batch = results[(size_t) BatchDesignedPath];
+    batch.passed = batch.passed && BatchDesigner::isWithinTolerance(sampleRate);
+
+    return results;
+}
+
+bool AccuracyGate::isEnabled(Path path)
+{
+    static_assert(std::size(AccuracyGateResults::passed) == numPaths, "the paths changed, record AccuracyGateResults.h again");
+
+    return getFallback(path) == path || AccuracyGateResults::passed[path];
+}
+
+bool AccuracyGate::isKernelEnabled(FilterKernels::Variant variant)
+{
+    switch( variant )
+    {
+        case FilterKernels::Avx2:   return isEnabled(Avx2KernelPath);
+        case FilterKernels::Avx512: return isEnabled(Avx512KernelPath);
+        default:                    return true;
+    }
+}
+
+juce::String AccuracyGate::createRecording(const std::vector<double>& sampleRates, const std::vector<std::array<Result, numPaths>>& runs)
+{
+    jassert(sampleRates.size() == runs.size());
+
+    //a kernel this cpu can't run isn't recorded as passed
+    std::array<bool, numPaths> passed;
+    passed.fill(true);
+
+    for( auto& results : runs )
+        for( size_t p = 0; p < passed.size(); ++p )
+            passed[p] = passed[p] && results[p].isSupported && results[p].passed;
+
+    juce::String text;
+    text << "/*\n"
+         << "  ==============================================================================\n"
+         << "\n"
+         << "    AccuracyGateResults.h\n"
+         << "    Which processing paths the last recorded accuracy run passed, and what it measured.\n"
+         << "\n"
+         << "    Written by GraphRunner --verify --record, don't edit it by hand.\n"
+         << "    Recorded " << juce::Time::getCurrentTime().formatted("%Y-%m-%d") << " on " << juce::SystemStats::getCpuModel() << ".\n"
+         << "\n"
+         << "  ==============================================================================\n"
+         << "*/\n"
+         << "\n"
+         << "#pragma once\n"
+         << "\n"
+         << "namespace AccuracyGateResults\n"
+         << "{\n"
+         << "    //in AccuracyGate::Path order, true if it passed at every sample rate --verify checks\n"
+         << "    constexpr bool passed[] =\n"
+         << "    {\n";
+
+    for( int p = 0; p < numPaths; ++p )
+        text << "        " << (passed[(size_t) p] ? "true, " : "false,") << "  //" << getName(static_cast<Path>(p)) << "\n";
+
+    text << "    };\n"
+         << "\n"
+         << "    //what the run measured, nothing reads it at runtime. kept next to the verdicts so a path's\n"
+         << "    //speed and error can be checked against what it was enabled on\n"
+         << "    constexpr double sampleRates[] = { ";
+
+    for( size_t r = 0; r < sampleRates.size(); ++r )
+        text << (r > 0 ? ", " : "") << juce::roundToInt(sampleRates[r]);
+
+    text << " };\n"
+         << "\n"
+         << "    struct Measurement\n"
+         << "    {\n"
+         << "        float magnitudeErrorDb, phaseErrorDegrees, outputErrorDb, nanosecondsPerSample;\n"
+         << "    };\n"
+         << "\n"
+         << "    //in AccuracyGate::Path order, then sampleRates order. ns per channel-sample, all zero\n"
+         << "    //where the cpu couldn't run the path\n"
+         << "    constexpr Measurement measurements[][" << (int) sampleRates.size() << "] =\n"
+         << "    {\n";
+
+    auto number = [](double value, int decimals)
+    {
+        return juce::String(value, decimals) + "f";
+    };
+
+    for( int p = 0; p < numPaths; ++p )
+    {
+        text << "        {   //" << getName(static_cast<Path>(p)) << "\n";
+
+        for( size_t r = 0; r < runs.size(); ++r )
+        {
+            auto& result = runs[r][(size_t) p];
+            Result measured;
+
+            if( result.isSupported )
+                measured = result;
+            else
+                measured.outputErrorDb = 0.f;
+
+            text << "            { " << number(measured.magnitudeErrorDb, 4) << ", " << number(measured.phaseErrorDegrees, 4) << ", "
+                 << number(measured.outputErrorDb, 2) << ", " << number(measured.nanosecondsPerSample, 2) << " },"
+                 << "  //" << juce::roundToInt(sampleRates[r]) << " Hz"
+                 << (! result.isSupported ? ", n/a on this cpu" : getFallback(static_cast<Path>(p)) == p ? "" : result.passed ? ", pass" : ", FAIL")
+                 << "\n";
+        }
+
+        text << "        },\n";
+    }
+
+    text << "    };\n"
+         << "}\n";
+
+    return text;
+}
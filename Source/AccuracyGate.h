@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    AccuracyGate.h
+    Checks the faster processing paths against a double precision reference.
+
+    Impulses, sweeps and noise are rendered through each path over a grid of
+    cut families, slopes, frequencies, gains and Qs, and compared with the same
+    chain designed and run in double precision: magnitude and phase of the
+    impulse response, and the difference of the rendered outputs.
+
+    Nothing is measured inside a host. GraphRunner --verify runs the check,
+    --record writes what passed into AccuracyGateResults.h, and the plugin
+    only switches on the paths recorded there.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct AccuracyGate
+{
+    enum Path
+    {
+        ScalarBiquadPath,   //juce designs, one chain per channel, what the l/r paths fall back to
+        MidSidePath,        //same chains with the m/s encode and decode as separate passes
+        BatchDesignedPath,
+        FusedMidSidePath,
+        SvfPath,
+        Avx2KernelPath,     //the biquad chains on the vector lane kernels
+        Avx512KernelPath,
+        numPaths
+    };
+
+    struct Result
+    {
+        float magnitudeErrorDb { 0.f };     //where the reference is above -60 dB
+        float phaseErrorDegrees { 0.f };    //where the reference is above -20 dB
+        float outputErrorDb { -200.f };     //difference of the renders, relative to the input
+        double nanosecondsPerSample { 0.0 };
+        int numSettings { 0 };
+        bool isSupported { true };          //false for a kernel this cpu can't run, nothing is rendered then
+        bool passed { true };
+    };
+
+    //a path passes if it's inside these, or no worse than the path it would replace,
+    //the float juce designs are themselves a fair way off at the bottom of the range
+    static constexpr float magnitudeToleranceDb = 0.1f;
+    static constexpr float phaseToleranceDegrees = 1.f;
+    static constexpr float outputToleranceDb = -60.f;
+
+    static const char* getName(Path path);
+
+    //what runs instead when a path doesn't pass, the two fallbacks are always on
+    static Path getFallback(Path path);
+
+    //renders the whole grid through every path, takes a few hundred ms. for GraphRunner --verify
+    static std::array<Result, numPaths> measure(double sampleRate);
+
+    //passed in the recorded run (or is a fallback), a lookup and nothing else
+    static bool isEnabled(Path path);
+
+    //isEnabled for the kernel's path, for FilterKernels::getSelectedVariant. generic always is
+    static bool isKernelEnabled(FilterKernels::Variant variant);
+
+    //the AccuracyGateResults.h for a run, one measure() per sample rate. a path is recorded as
+    //passed if it passed at every one of them, its numbers are written out alongside
+    static juce::String createRecording(const std::vector<double>& sampleRates, const std::vector<std::array<Result, numPaths>>& runs);
+};
@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    AccuracyGateResults.h
+    Which processing paths the last recorded accuracy run passed, and what it measured.
+
+    Written by GraphRunner --verify --record, don't edit it by hand.
+    Recorded 2026-10-19 on Intel(R) Xeon(R) Processor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace AccuracyGateResults
+{
+    //in AccuracyGate::Path order, true if it passed at every sample rate --verify checks
+    constexpr bool passed[] =
+    {
+        true,   //scalar biquad
+        true,   //mid/side
+        false,  //batch designed
+        true,   //fused mid/side
+        true,   //svf
+        true,   //avx2 kernel
+        true,   //avx512 kernel
+    };
+
+    //what the run measured, nothing reads it at runtime. kept next to the verdicts so a path's
+    //speed and error can be checked against what it was enabled on
+    constexpr double sampleRates[] = { 44100, 48000, 88200, 96000, 176400, 192000 };
+
+    struct Measurement
+    {
+        float magnitudeErrorDb, phaseErrorDegrees, outputErrorDb, nanosecondsPerSample;
+    };
+
+    //in AccuracyGate::Path order, then sampleRates order. ns per channel-sample, all zero
+    //where the cpu couldn't run the path
+    constexpr Measurement measurements[][6] =
+    {
+        {   //scalar biquad
+            { 5.4647f, 12.4846f, -34.95f, 18.95f },  //44100 Hz
+            { 4.3526f, 66.6760f, -40.02f, 19.94f },  //48000 Hz
+            { 5.4650f, 12.4848f, -29.89f, 19.59f },  //88200 Hz
+            { 4.3428f, 66.6805f, -32.94f, 19.16f },  //96000 Hz
+            { 3.8933f, 10.4379f, -33.33f, 19.70f },  //176400 Hz
+            { 4.3274f, 66.6879f, -29.01f, 19.32f },  //192000 Hz
+        },
+        {   //mid/side
+            { 3.4662f, 7.8167f, -37.73f, 18.67f },  //44100 Hz
+            { 23.8550f, 27.5202f, -40.18f, 19.08f },  //48000 Hz
+            { 3.3494f, 7.9755f, -36.95f, 19.97f },  //88200 Hz
+            { 2.4907f, 32.4732f, -42.97f, 18.15f },  //96000 Hz
+            { 3.2244f, 16.9128f, -35.09f, 18.34f },  //176400 Hz
+            { 3.8283f, 34.6112f, -33.67f, 18.32f },  //192000 Hz
+        },
+        {   //batch designed
+            { 5.4326f, 11.1814f, -34.78f, 19.04f },  //44100 Hz, pass
+            { 4.4903f, 55.3877f, -39.07f, 20.43f },  //48000 Hz, pass
+            { 5.4329f, 11.1816f, -34.30f, 20.54f },  //88200 Hz, pass
+            { 4.4810f, 55.3902f, -33.02f, 19.27f },  //96000 Hz, pass
+            { 4.8412f, 19.8228f, -29.73f, 19.38f },  //176400 Hz, FAIL
+            { 4.4663f, 55.3946f, -28.10f, 19.76f },  //192000 Hz, pass
+        },
+        {   //fused mid/side
+            { 3.4662f, 7.8167f, -37.73f, 19.54f },  //44100 Hz, pass
+            { 23.8550f, 27.5202f, -40.18f, 19.08f },  //48000 Hz, pass
+            { 3.3494f, 7.9755f, -36.95f, 18.45f },  //88200 Hz, pass
+            { 2.4907f, 32.4732f, -42.97f, 19.15f },  //96000 Hz, pass
+            { 3.2244f, 16.9128f, -35.09f, 19.26f },  //176400 Hz, pass
+            { 3.8283f, 34.6112f, -33.67f, 18.38f },  //192000 Hz, pass
+        },
+        {   //svf
+            { 0.0267f, 0.0888f, -79.76f, 36.06f },  //44100 Hz, pass
+            { 0.0165f, 0.0850f, -76.42f, 39.39f },  //48000 Hz, pass
+            { 0.0182f, 0.1007f, -73.52f, 38.47f },  //88200 Hz, pass
+            { 0.0214f, 0.0850f, -77.59f, 36.90f },  //96000 Hz, pass
+            { 0.0392f, 0.0630f, -75.53f, 36.54f },  //176400 Hz, pass
+            { 0.0287f, 0.0850f, -76.67f, 37.30f },  //192000 Hz, pass
+        },
+        {   //avx2 kernel
+            { 5.4647f, 12.4846f, -34.95f, 11.33f },  //44100 Hz, pass
+            { 4.3526f, 66.6760f, -40.02f, 12.99f },  //48000 Hz, pass
+            { 5.4650f, 12.4848f, -29.89f, 12.37f },  //88200 Hz, pass
+            { 4.3428f, 66.6805f, -32.94f, 12.83f },  //96000 Hz, pass
+            { 3.8933f, 10.4379f, -33.33f, 12.90f },  //176400 Hz, pass
+            { 4.3274f, 66.6879f, -29.01f, 12.05f },  //192000 Hz, pass
+        },
+        {   //avx512 kernel
+            { 5.4647f, 12.4846f, -34.95f, 12.30f },  //44100 Hz, pass
+            { 4.3526f, 66.6760f, -40.02f, 14.22f },  //48000 Hz, pass
+            { 5.4650f, 12.4848f, -29.89f, 13.91f },  //88200 Hz, pass
+            { 4.3428f, 66.6805f, -32.94f, 14.05f },  //96000 Hz, pass
+            { 3.8933f, 10.4379f, -33.33f, 12.82f },  //176400 Hz, pass
+            { 4.3274f, 66.6879f, -29.01f, 13.28f },  //192000 Hz, pass
+        },
+    };
+}
@@ -0,0 +1,282 @@
+/*
+  ==============================================================================
+
+    BatchDesigner.cpp
+    Designs every biquad section of one or more chains in a single pass.
+
+  ==============================================================================
+*/
+
+#include "BatchDesigner.h"
+#include "PluginProcessor.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  polynomials for the ranges we actually hit, no range reduction needed.
+//  sin / cos only ever see half the digital frequency, [0, 0.49 pi], where the
+//  truncated taylor series are good to a couple of parts in 1e7
+
+static inline float fastSin(float x)
+{
+    auto x2 = x * x;
+    return x * (1.f + x2 * (-1.f / 6.f + x2 * (1.f / 120.f + x2 * (-1.f / 5040.f + x2 * (1.f / 362880.f + x2 * (-1.f / 39916800.f))))));
+}
+
+static inline float fastCos(float x)
+{
+    auto x2 = x * x;
+    return 1.f + x2 * (-0.5f + x2 * (1.f / 24.f + x2 * (-1.f / 720.f + x2 * (1.f / 40320.f + x2 * (-1.f / 3628800.f + x2 * (1.f / 479001600.f))))));
+}
+
+//10^(dB / 40) for dB in [-24, 24]: e^y with |y| < 0.35, then squared twice
+static inline float fastBellGain(float decibels)
+{
+    auto y = decibels * 0.01439115683f; // ln(10) / 160
+    auto e = 1.f + y * (1.f + y * (0.5f + y * (1.f / 6.f + y * (1.f / 24.f + y * (1.f / 120.f + y * (1.f / 720.f + y * (1.f / 5040.f)))))));
+    e *= e;
+    return e * e;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void BatchDesigner::clear()
+{
+    //idle lanes still get designed, give them something harmless
+    for( int i = 0; i < capacity; ++i )
+    {
+        frequency[i] = 1000.f;
+        scale[i] = damping[i] = gain[i] = 1.f;
+        gainDb[i] = 0.f;
+        isLowPass[i] = isHighPass[i] = isBell[i] = isFirstOrder[i] = 0.f;
+    }
+
+    numSections = 0;
+}
+
+int BatchDesigner::addBell(float sectionFrequency, float sectionQuality, float sectionGainDb)
+{
+    jassert(numSections < capacity);
+    auto i = numSections++;
+
+    frequency[i] = sectionFrequency;
+    damping[i] = 1.f / sectionQuality;
+    gainDb[i] = sectionGainDb;
+    isBell[i] = 1.f;
+
+    return i;
+}
+
+int BatchDesigner::addCutSection(const PrototypeSection& section, double sectionGain, float sectionFrequency, bool isHighPassSection)
+{
+    jassert(numSections < capacity);
+    auto i = numSections++;
+    auto isFirstOrderSection = section.quality == 0.0;
+
+    frequency[i] = sectionFrequency;
+    scale[i] = (float) (isHighPassSection ? 1.0 / section.frequency : section.frequency);
+    damping[i] = isFirstOrderSection ? 0.f : (float) (1.0 / section.quality);
+    gain[i] = (float) sectionGain;
+    isLowPass[i] = isHighPassSection ? 0.f : 1.f;
+    isHighPass[i] = isHighPassSection ? 1.f : 0.f;
+    isFirstOrder[i] = isFirstOrderSection ? 1.f : 0.f;
+
+    return i;
+}
+
+void BatchDesigner::addCut(const CutPrototype& prototype, float cutFrequency, bool isHighPassCut, int* indices)
+{
+    for( int s = 0; s < prototype.numSections; ++s )
+        indices[s] = addCutSection(prototype.sections[(size_t) s], s == 0 ? prototype.gain : 1.0, cutFrequency, isHighPassCut);
+}
+
+void BatchDesigner::run(double sampleRate)
+{
+    //pi / fs split over two floats, a single float product is off by enough
+    //to move the resonant sections of the steep cuts
+    auto piOverSampleRate = juce::MathConstants<double>::pi / sampleRate;
+    auto piOverSampleRateHigh = (float) piOverSampleRate;
+    auto piOverSampleRateLow = (float) (piOverSampleRate - (double) piOverSampleRateHigh);
+    auto maxHalfW = 0.49f * juce::MathConstants<float>::pi;
+
+    //bilinear transforms prewarped with tan(w / 2), the same as the cookbook forms.
+    //a1 and a2 are written as offsets from -2 and 1 so they don't lose the small
+    //part at low frequencies. one body for every section type, the type masks
+    //pick the terms so there are no branches in the loop
+    for( int i = 0; i < capacity; ++i )
+    {
+        auto halfW = std::min(frequency[i] * piOverSampleRateHigh + frequency[i] * piOverSampleRateLow, maxHalfW);
+        auto W = scale[i] * fastSin(halfW) / fastCos(halfW);
+        auto W2 = W * W;
+
+        auto A = fastBellGain(gainDb[i]);   //exactly 1 for the cut sections
+        auto d = damping[i] / A;
+        auto n = damping[i] * A;
+
+        auto isSecondOrder = 1.f - isFirstOrder[i];
+        auto invA0 = 1.f / (isSecondOrder * (1.f + W * d + W2) + isFirstOrder[i] * (1.f + W));
+
+        auto cutScale = gain[i] * invA0;
+        auto lowPassB0 = isSecondOrder * W2 + isFirstOrder[i] * W;
+        auto lowPassB1 = isSecondOrder * 2.f * W2 + isFirstOrder[i] * W;
+
+        a1[i] = isSecondOrder * (-2.f + (4.f * W2 + 2.f * W * d) * invA0) + isFirstOrder[i] * (-1.f + 2.f * W * invA0);
+        a2[i] = isSecondOrder * (1.f - 2.f * W * d * invA0);
+
+        b0[i] = (isLowPass[i] * lowPassB0 + isHighPass[i]) * cutScale + isBell[i] * (1.f + W * (n - d) * invA0);
+        b1[i] = (isLowPass[i] * lowPassB1 - isHighPass[i] * (2.f * isSecondOrder + isFirstOrder[i])) * cutScale + isBell[i] * a1[i];
+        b2[i] = isSecondOrder * (isLowPass[i] * W2 + isHighPass[i]) * cutScale + isBell[i] * (1.f - W * (n + d) * invA0);
+    }
+}
+
+BiquadCoefficients BatchDesigner::getSection(int index) const
+{
+    return { b0[index], b1[index], b2[index], 1.f, a1[index], a2[index] };
+}
+
+void BatchDesigner::design(const ChainSettings* settings, ChainCoefficients* results, int numChains, double sampleRate)
+{
+    jassert(numChains <= maxChains);
+    clear();
+
+    //low cut sections, peak, high cut sections
+    std::array<std::array<int, 2 * maxCutSections + 1>, maxChains> indices;
+    std::array<const CutPrototype*, maxChains> lowCuts, highCuts;
+
+    for( int c = 0; c < numChains; ++c )
+    {
+        auto& s = settings[c];
+        auto& index = indices[(size_t) c];
+        lowCuts[(size_t) c] = &getCutPrototype(s.lowCutFamily, getCutFilterOrder(s.lowCutSlope));
+        highCuts[(size_t) c] = &getCutPrototype(s.highCutFamily, getCutFilterOrder(s.highCutSlope));
+
+        addCut(*lowCuts[(size_t) c], s.lowCutFreq, true, index.data());
+        index[maxCutSections] = addBell(s.peakFreq, s.peakQuality, s.peakGainInDecibels);
+        addCut(*highCuts[(size_t) c], s.highCutFreq, false, index.data() + maxCutSections + 1);
+    }
+
+    run(sampleRate);
+
+    for( int c = 0; c < numChains; ++c )
+    {
+        auto& index = indices[(size_t) c];
+        auto& result = results[c];
+
+        result.lowCut.numSections = lowCuts[(size_t) c]->numSections;
+        result.highCut.numSections = highCuts[(size_t) c]->numSections;
+
+        for( int i = 0; i < result.lowCut.numSections; ++i )
+            result.lowCut.sections[(size_t) i] = getSection(index[(size_t) i]);
+
+        result.peak = getSection(index[maxCutSections]);
+
+        for( int i = 0; i < result.highCut.numSections; ++i )
+            result.highCut.sections[(size_t) i] = getSection(index[(size_t) (maxCutSections + 1 + i)]);
+    }
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  the same designs done in double precision with the library functions
+static double getExactMagnitude(const std::array<double, 6>& c, double frequency, double sampleRate)
+{
+    auto z = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+    return std::abs((c[0] + c[1] * z + c[2] * z * z) / (c[3] + c[4] * z + c[5] * z * z));
+}
+
+static std::array<double, 6> makeExactBell(double sectionFrequency, double q, double decibels, double sampleRate)
+{
+    auto w = juce::MathConstants<double>::twoPi * sectionFrequency / sampleRate;
+    auto alpha = std::sin(w) / (2.0 * q);
+    auto cosW = std::cos(w);
+    auto A = std::pow(10.0, decibels / 40.0);
+
+    return { 1.0 + alpha * A, -2.0 * cosW, 1.0 - alpha * A, 1.0 + alpha / A, -2.0 * cosW, 1.0 - alpha / A };
+}
+
+float BatchDesigner::measureMaxErrorDb(double sampleRate, double minNormalisedFrequency)
+{
+    BatchDesigner designer;
+    designer.clear();
+    std::vector<std::array<double, 6>> exact;
+    double worstDb = 0.0;
+
+    //designs a batch and compares it with the exact designs of the same sections
+    auto flush = [&]
+    {
+        designer.run(sampleRate);
+
+        for( size_t d = 0; d < exact.size(); ++d )
+        {
+            auto section = designer.getSection((int) d);
+
+            for( int k = 0; k < 64; ++k )
+            {
+                auto frequency = juce::mapToLog10(k / 63.0, 20.0, juce::jmin(20000.0, 0.49 * sampleRate));
+                auto exactDb = juce::Decibels::gainToDecibels(getExactMagnitude(exact[d], frequency, sampleRate), -200.0);
+
+                if( exactDb < -60.0 )
+                    continue;
+
+                auto batchDb = juce::Decibels::gainToDecibels(getMagnitudeForFrequency(section, frequency, sampleRate), -200.0);
+                worstDb = juce::jmax(worstDb, std::abs(batchDb - exactDb));
+            }
+        }
+
+        designer.clear();
+        exact.clear();
+    };
+
+    auto add = [&](const std::array<double, 6>& exactDesign)
+    {
+        exact.push_back(exactDesign);
+
+        if( (int) exact.size() == capacity )
+            flush();
+    };
+
+    for( int f = 0; f < 48; ++f )
+    {
+        auto designFrequency = (float) std::round(juce::mapToLog10(f / 47.0, 20.0, 20000.0));
+
+        if( designFrequency < minNormalisedFrequency * sampleRate || designFrequency >= 0.49 * sampleRate )
+            continue;
+
+        //the first order sections, the lowest Qs and the highest, without going through every order
+        for( int family = CutFamily::Butterworth; family <= CutFamily::Chebyshev; ++family )
+        {
+            for( int order : { 1, 2, 3, 8, 2 * maxCutSections - 1, 2 * maxCutSections } )
+            {
+                auto& prototype = getCutPrototype(static_cast<CutFamily>(family), order);
+
+                for( int i = 0; i < prototype.numSections; ++i )
+                {
+                    auto& section = prototype.sections[(size_t) i];
+                    auto sectionGain = i == 0 ? prototype.gain : 1.0;
+
+                    for( auto isHighPassSection : { true, false } )
+                    {
+                        designer.addCutSection(section, sectionGain, designFrequency, isHighPassSection);
+                        add(designCutSection(section, sectionGain, designFrequency, sampleRate, isHighPassSection));
+                    }
+                }
+            }
+        }
+
+        for( float gainDb = -24.f; gainDb <= 24.f; gainDb += 6.f )
+        {
+            for( float q = 0.1f; q <= 10.f; q += 1.5f )
+            {
+                designer.addBell(designFrequency, q, gainDb);
+                add(makeExactBell(designFrequency, q, gainDb, sampleRate));
+            }
+        }
+    }
+
+    if( ! exact.empty() )
+        flush();
+
+    return (float) worstDb;
+}
+
+bool BatchDesigner::isWithinTolerance(double sampleRate)
+{
+    return measureMaxErrorDb(sampleRate, 1.0 / 500.0) <= toleranceDb
+        && measureMaxErrorDb(sampleRate, 1.0 / 1000.0) <= lowFrequencyToleranceDb;
+}
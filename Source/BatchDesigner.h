@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    BatchDesigner.h
+    Designs every biquad section of one or more chains in a single pass.
+
+    All the sections (cut cascades and peak, for both channels) are laid out
+    side by side and run through one branch-free loop the compiler turns into
+    SIMD, with polynomial sin / cos / exp in place of the library calls.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CutPrototype.h"
+#include "FilterKernels.h"
+
+struct ChainSettings;
+struct ChainCoefficients;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct BatchDesigner
+{
+    //two chains of eight + one + eight sections, padded out to whole vectors
+    static constexpr int maxChains = 2;
+    static constexpr int capacity = 40;
+
+    //magnitude error against the double precision designs, wherever the response is above -60 dB,
+    //for designs at or above fs / 500 and fs / 1000. lower than that a float direct form can't
+    //hold the poles well whoever designs it, the juce designs are just as far off there
+    static constexpr float toleranceDb = 0.1f;
+    static constexpr float lowFrequencyToleranceDb = 0.6f;
+
+    void design(const ChainSettings* settings, ChainCoefficients* results, int numChains, double sampleRate);
+
+    //worst error over a grid of frequencies, families, orders, gains and Qs,
+    //counting designs at or above minNormalisedFrequency * sampleRate
+    static float measureMaxErrorDb(double sampleRate, double minNormalisedFrequency);
+
+    //checks both tolerances, a few hundred ms. AccuracyGate::measure runs it for the batch designed path
+    static bool isWithinTolerance(double sampleRate);
+
+private:
+    //scale is the prototype pole frequency (or its inverse for highpass), damping 1 / Q,
+    //gain the linear gain of a cut section. not over-aligned so the designer can sit in the
+    //processor, the loop vectorises with unaligned loads just as well
+    float frequency[capacity] {}, scale[capacity] {}, damping[capacity] {}, gain[capacity] {}, gainDb[capacity] {};
+    float isLowPass[capacity] {}, isHighPass[capacity] {}, isBell[capacity] {}, isFirstOrder[capacity] {};
+    float b0[capacity] {}, b1[capacity] {}, b2[capacity] {}, a1[capacity] {}, a2[capacity] {};
+    int numSections { 0 };
+
+    void clear();
+    int addBell(float sectionFrequency, float sectionQuality, float sectionGainDb);
+    int addCutSection(const PrototypeSection& section, double sectionGain, float sectionFrequency, bool isHighPassSection);
+    void addCut(const CutPrototype& prototype, float cutFrequency, bool isHighPassCut, int* indices);
+    void run(double sampleRate);
+    BiquadCoefficients getSection(int index) const;
+};
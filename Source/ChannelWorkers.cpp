@@ -0,0 +1,326 @@
+/*
+  ==============================================================================
+
+    ChannelWorkers.cpp
+    Spreads the chains of a wide bus over a few worker threads.
+
+  ==============================================================================
+*/
+
+#include "ChannelWorkers.h"
+#include "PluginProcessor.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+#if JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#elif JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#else
+ #include <semaphore.h>
+ #include <cerrno>
+ #include <ctime>
+#endif
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//the parallel part of a block has to be done inside this share of the block's real time
+static constexpr double deadlineFraction = 0.5;
+
+//workers spin this long after a block (at most) before they park
+static constexpr double maxSpinSeconds = 0.001;
+
+//tells the core we're spinning, so a hyperthread sibling gets the pipeline
+static inline void spinPause() noexcept
+{
+   #if JUCE_INTEL
+    _mm_pause();
+   #elif JUCE_ARM && (JUCE_GCC || JUCE_CLANG)
+    __asm__ __volatile__ ("yield");
+   #endif
+}
+
+static inline juce::uint64 makeClaims(juce::uint32 blockGeneration, int lastChannel, int nextChannel) noexcept
+{
+    return ((juce::uint64) blockGeneration << 32) | ((juce::uint64) lastChannel << 16) | (juce::uint64) nextChannel;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  what a parked worker waits on. posting is a single atomic or a syscall, never a mutex,
+//  unlike WaitableEvent::signal, so the audio thread can do it
+class Semaphore
+{
+public:
+   #if JUCE_MAC || JUCE_IOS
+    Semaphore() : semaphore(dispatch_semaphore_create(0)) {}
+    ~Semaphore() { dispatch_release(semaphore); }
+
+    void post() noexcept { dispatch_semaphore_signal(semaphore); }
+    void wait(int milliseconds) noexcept { dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t) milliseconds * NSEC_PER_MSEC)); }
+   #elif JUCE_WINDOWS
+    Semaphore() : semaphore(CreateSemaphoreW(nullptr, 0, 0x7fffffff, nullptr)) {}
+    ~Semaphore() { CloseHandle(semaphore); }
+
+    void post() noexcept { ReleaseSemaphore(semaphore, 1, nullptr); }
+    void wait(int milliseconds) noexcept { WaitForSingleObject(semaphore, (DWORD) milliseconds); }
+   #else
+    Semaphore() { sem_init(&semaphore, 0, 0); }
+    ~Semaphore() { sem_destroy(&semaphore); }
+
+    void post() noexcept { sem_post(&semaphore); }
+
+    void wait(int milliseconds) noexcept
+    {
+        timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += (long) milliseconds * 1000000;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000;
+        deadline.tv_nsec %= 1000000000;
+
+        while( sem_timedwait(&semaphore, &deadline) != 0 && errno == EINTR ) {}
+    }
+   #endif
+
+private:
+   #if JUCE_MAC || JUCE_IOS
+    dispatch_semaphore_t semaphore;
+   #elif JUCE_WINDOWS
+    HANDLE semaphore;
+   #else
+    sem_t semaphore;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE(Semaphore)
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct ChannelWorkers::Worker : public juce::Thread
+{
+    Worker(ChannelWorkers& o, int workerIndex, juce::int64 ticksToSpin)
+        : juce::Thread("SimpleEq channels " + juce::String(workerIndex)), owner(o), index(workerIndex), spinTicks(ticksToSpin)
+    {
+    }
+
+    ChannelWorkers& owner;
+    const int index;
+    const juce::int64 spinTicks;
+
+    std::atomic<bool> isParked { false };
+    Semaphore wakeUp;
+
+    void run() override
+    {
+        juce::ScopedNoDenormals noDenormals;
+        auto seen = owner.generation.load(std::memory_order_acquire);
+
+        while( ! threadShouldExit() )
+        {
+            auto spinEnd = juce::Time::getHighResolutionTicks() + spinTicks;
+
+            while( owner.generation.load(std::memory_order_acquire) == seen
+                   && juce::Time::getHighResolutionTicks() < spinEnd )
+                spinPause();
+
+            if( owner.generation.load(std::memory_order_acquire) == seen )
+            {
+                //checked again after saying we're parked, a block published in between isn't missed.
+                //a post we didn't need just makes the next wait return early
+                isParked.store(true);
+
+                if( owner.generation.load() == seen && ! threadShouldExit() )
+                    wakeUp.wait(100);
+
+                isParked.store(false);
+                continue;
+            }
+
+            seen = owner.generation.load(std::memory_order_acquire);
+
+            //start on our own group, the audio thread starts on the first
+            owner.runGroups(index + 1, seen);
+        }
+    }
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ChannelWorkers::ChannelWorkers(int numWorkers, double rate, int maximumBlockSize) : sampleRate(rate)
+{
+    static_assert(std::is_trivially_destructible<Group>::value, "the groups are never destroyed, only freed");
+
+    //room to slide the start up to the next cache line
+    maxGroups = numWorkers + 1;
+    groupMemory.allocate(sizeof(Group) * (size_t) maxGroups + alignof(Group), false);
+    auto address = reinterpret_cast<std::uintptr_t>(groupMemory.get());
+    auto aligned = (address + alignof(Group) - 1) & ~(std::uintptr_t) (alignof(Group) - 1);
+    groups = reinterpret_cast<Group*>(aligned);
+
+    for( int g = 0; g < maxGroups; ++g )
+        new (groups + g) Group();
+
+    auto blockSeconds = juce::jmax(1, maximumBlockSize) / sampleRate;
+    auto spinTicks = juce::Time::secondsToHighResolutionTicks(juce::jmin(blockSeconds, maxSpinSeconds));
+
+    //not pinned: every instance would pin to the same cores, the scheduler spreads them better
+    for( int w = 0; w < numWorkers; ++w )
+    {
+        workers.push_back(std::make_unique<Worker>(*this, w, spinTicks));
+        auto& worker = *workers.back();
+
+        //without realtime rights (linux without rtprio) the highest normal priority still beats the gui
+        if( ! worker.startRealtimeThread(juce::Thread::RealtimeOptions{}.withApproximateAudioProcessingTime(maximumBlockSize, sampleRate)) )
+            worker.startThread(juce::Thread::Priority::highest);
+    }
+}
+
+ChannelWorkers::~ChannelWorkers()
+{
+    for( auto& worker : workers )
+    {
+        worker->signalThreadShouldExit();
+        worker->wakeUp.post();
+    }
+
+    for( auto& worker : workers )
+        worker->stopThread(1000);
+}
+
+int ChannelWorkers::getDefaultNumWorkers()
+{
+    static const int numWorkers = juce::jlimit(0, 63, juce::SystemStats::getEnvironmentVariable("SIMPLEEQ_CHANNEL_WORKERS", "0").getIntValue());
+    return numWorkers;
+}
+
+ChannelWorkers::Stats ChannelWorkers::getStats() const
+{
+    return { parallelBlocks.load(), missedDeadlines.load(), stolenChannels.load(), fallbacks.load() };
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool ChannelWorkers::process(ChainBlock& chainsToRun, const juce::dsp::AudioBlock<float>& blockToRun)
+{
+    if( serialBlocksLeft > 0 )
+    {
+        --serialBlocksLeft;
+        return false;
+    }
+
+    auto numChannels = (int) blockToRun.getNumChannels();
+    auto numGroups = juce::jmin(maxGroups, numChannels / minChannelsPerGroup);
+
+    if( numGroups < 2 )
+        return false;
+
+    //every channel of the last block is done here, and nobody claims from these
+    //until the claims carry the new generation
+    auto blockGeneration = generation.load(std::memory_order_relaxed) + 1;
+    chains = &chainsToRun;
+    block = blockToRun;
+    remaining.store(numChannels, std::memory_order_relaxed);
+
+    //groups past numGroups keep an old generation, so they count as empty
+    for( int g = 0; g < numGroups; ++g )
+        groups[g].claims.store(makeClaims(blockGeneration, numChannels * (g + 1) / numGroups, numChannels * g / numGroups),
+                               std::memory_order_release);
+
+    generation.store(blockGeneration);
+
+    for( auto& worker : workers )
+    {
+        if( worker->isParked.load() )
+            worker->wakeUp.post();
+    }
+
+    auto start = juce::Time::getHighResolutionTicks();
+    auto deadline = deadlineFraction * (double) blockToRun.getNumSamples() / sampleRate;
+    auto deadlineTicks = start + juce::Time::secondsToHighResolutionTicks(deadline);
+
+    //our own group, then whatever the workers haven't got to yet
+    auto ranHere = runGroup(groups[0], blockGeneration);
+    auto stolen = runGroups(1, blockGeneration);
+
+    //every channel is claimed by now, what's left are the ones workers are in the middle of,
+    //at most one claim each. past the deadline stop spinning and give the core up, in case one of
+    //them was preempted on it
+    while( remaining.load(std::memory_order_acquire) > 0 )
+    {
+        if( juce::Time::getHighResolutionTicks() < deadlineTicks )
+            spinPause();
+        else
+            juce::Thread::yield();
+    }
+
+    auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+    parallelBlocks.fetch_add(1, std::memory_order_relaxed);
+    stolenChannels.fetch_add(stolen, std::memory_order_relaxed);
+
+    //late, or no worker turned up in time and it was serial anyway
+    if( seconds > deadline || ranHere + stolen == numChannels )
+    {
+        missedDeadlines.fetch_add(1, std::memory_order_relaxed);
+
+        if( ++consecutiveMisses >= maxConsecutiveMisses )
+        {
+            fallbacks.fetch_add(1, std::memory_order_relaxed);
+            serialBlocksLeft = serialBlocks;
+            consecutiveMisses = 0;
+        }
+    }
+    else
+    {
+        consecutiveMisses = 0;
+    }
+
+    return true;
+}
+
+int ChannelWorkers::runGroups(int first, juce::uint32 blockGeneration)
+{
+    int numRun = 0;
+
+    for( int i = 0; i < maxGroups; ++i )
+        numRun += runGroup(groups[(first + i) % maxGroups], blockGeneration);
+
+    return numRun;
+}
+
+int ChannelWorkers::runGroup(Group& group, juce::uint32 blockGeneration)
+{
+    auto claims = group.claims.load(std::memory_order_acquire);
+
+    auto isClaimable = [&claims, blockGeneration]
+    {
+        return (juce::uint32) (claims >> 32) == blockGeneration && (claims & 0xffff) < ((claims >> 16) & 0xffff);
+    };
+
+    if( ! isClaimable() )
+        return 0;
+
+    Trace::Scope traceScope { "channelGroup" };
+    int numRun = 0;
+
+    //a kernel's lane width of channels per claim, so they go through the recursion together.
+    //whoever gets here first takes what's left and nothing runs twice
+    auto laneWidth = chains->getLaneWidth();
+
+    while( isClaimable() )
+    {
+        auto channel = (int) (claims & 0xffff);
+        auto numChannels = juce::jmin(laneWidth, (int) ((claims >> 16) & 0xffff) - channel);
+
+        if( ! group.claims.compare_exchange_weak(claims, claims + (juce::uint64) numChannels, std::memory_order_acq_rel, std::memory_order_acquire) )
+            continue;
+
+        claims += (juce::uint64) numChannels;
+        chains->process(block, channel, numChannels);
+
+        remaining.fetch_sub(numChannels, std::memory_order_release);
+        numRun += numChannels;
+    }
+
+    return numRun;
+}
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    ChannelWorkers.h
+    Spreads the chains of a wide bus over a few worker threads.
+
+    Opt in, for 16 to 64 channel buses where one core can't get through every
+    channel inside the block. Each block the channels are cut into contiguous
+    groups, each thread starts on its own group and claims channels from it as
+    many at a time as the kernel runs side by side, then claims from the others
+    until none are left. Workers spin for a while after each block and then
+    park on a semaphore, the audio thread never takes a lock: it posts to
+    parked workers, runs channels itself, and only ever waits for channels a
+    worker is in the middle of. When the blocks keep finishing after the
+    deadline the processor goes back to one thread for a while.
+
+    Set SIMPLEEQ_CHANNEL_WORKERS=N (or call setChannelWorkers) to turn it on.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class ChainBlock;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class ChannelWorkers
+{
+public:
+    //buses narrower than this aren't worth waking anyone for
+    static constexpr int minChannels = 8;
+
+    //a group is never smaller than this, the handoff costs more than a couple of chains
+    static constexpr int minChannelsPerGroup = 2;
+
+    //missed this many blocks in a row: run serially for serialBlocks, then try again
+    static constexpr int maxConsecutiveMisses = 8;
+    static constexpr int serialBlocks = 1000;
+
+    //starts the threads, the os decides where they run
+    ChannelWorkers(int numWorkers, double sampleRate, int maximumBlockSize);
+    ~ChannelWorkers();
+
+    int getNumWorkers() const { return (int) workers.size(); }
+
+    //processes every channel of block through its chain, false if it's in serial fallback
+    //and the caller has to do it. audio thread only
+    bool process(ChainBlock& chains, const juce::dsp::AudioBlock<float>& block);
+
+    struct Stats
+    {
+        //stolenChannels are the ones the audio thread ran from the workers' groups
+        juce::int64 parallelBlocks { 0 }, missedDeadlines { 0 }, stolenChannels { 0 }, fallbacks { 0 };
+    };
+
+    Stats getStats() const;
+
+    //environment default, 0 if it isn't set
+    static int getDefaultNumWorkers();
+
+private:
+    struct Worker;
+
+    //  one group of channels, on its own cache line so claiming from it doesn't bounce the others.
+    //  claims holds the block's generation in the top 32 bits, then the group's last channel and
+    //  the next channel to hand out, 16 bits each. a thread still finishing the last block sees
+    //  the old generation and can't claim from this one
+    struct alignas(64) Group
+    {
+        std::atomic<juce::uint64> claims { 0 };
+    };
+
+    //what the current block is, written before the generation goes up
+    ChainBlock* chains { nullptr };
+    juce::dsp::AudioBlock<float> block;
+
+    //one per thread, aligned by hand like the ChainBlock
+    juce::HeapBlock<char> groupMemory;
+    Group* groups { nullptr };
+    int maxGroups { 0 };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<juce::uint32> generation { 0 };
+    std::atomic<int> remaining { 0 };
+
+    double sampleRate;
+    int consecutiveMisses { 0 };
+    int serialBlocksLeft { 0 };
+
+    std::atomic<juce::int64> parallelBlocks { 0 }, missedDeadlines { 0 }, stolenChannels { 0 }, fallbacks { 0 };
+
+    //claims and runs channels of blockGeneration from every group, group first first.
+    //both return how many channels they ran
+    int runGroups(int first, juce::uint32 blockGeneration);
+    int runGroup(Group& group, juce::uint32 blockGeneration);
+
+    JUCE_DECLARE_NON_COPYABLE(ChannelWorkers)
+};
@@ -0,0 +1,206 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.cpp
+    Process-wide cache of designed filter coefficients.
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+CoefficientCache::CoefficientCache()
+    : sets(new Set[(size_t) numSets])
+{
+}
+
+size_t CoefficientCache::hashKey(const Key& key)
+{
+    auto mix = [](juce::uint64 h, juce::uint64 v)
+    {
+        h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        return h;
+    };
+
+    juce::uint64 h = (juce::uint64) key.type;
+    h = mix(h, (juce::uint64) key.sampleRate);
+    h = mix(h, (juce::uint64) juce::roundToInt(key.frequency));
+    h = mix(h, (juce::uint64) juce::roundToInt(key.first * 2.f));
+    h = mix(h, (juce::uint64) juce::roundToInt(key.second * 2.f));
+
+    return (size_t) (h % (juce::uint64) numSets);
+}
+
+bool CoefficientCache::find(const Key& key, CutCoefficients& result)
+{
+    auto& set = sets[hashKey(key)];
+
+    for( auto& entry : set.ways )
+    {
+        auto before = entry.sequence.load(std::memory_order_acquire);
+
+        if( (before & 1) != 0 || ! (entry.key.load() == key) )
+            continue;
+
+        result = entry.coefficients.load();
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        //the entry got rewritten while we were copying it
+        if( entry.sequence.load(std::memory_order_relaxed) != before )
+            continue;
+
+        entry.lastUsed.store(clock.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
+
+void CoefficientCache::insert(const Key& key, const CutCoefficients& coefficients)
+{
+    auto& set = sets[hashKey(key)];
+
+    //another thread is filling this set, it's only a cache so don't wait for it
+    if( set.writeLock.test_and_set(std::memory_order_acquire) )
+        return;
+
+    //least recently used way gets evicted
+    auto* victim = &set.ways[0];
+
+    for( auto& entry : set.ways )
+    {
+        if( entry.lastUsed.load(std::memory_order_relaxed) < victim->lastUsed.load(std::memory_order_relaxed) )
+            victim = &entry;
+    }
+
+    auto sequence = victim->sequence.load(std::memory_order_relaxed);
+    victim->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    victim->key.store(key);
+    victim->coefficients.store(coefficients);
+
+    victim->sequence.store(sequence + 2, std::memory_order_release);
+    victim->lastUsed.store(clock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+
+    set.writeLock.clear(std::memory_order_release);
+}
+
+bool CoefficientCache::findCounted(const Key& key, CutCoefficients& result)
+{
+    auto found = find(key, result);
+    (found ? hits : misses).fetch_add(1, std::memory_order_relaxed);
+    return found;
+}
+
+template<typename DesignFunction>
+CutCoefficients CoefficientCache::lookup(const Key& key, DesignFunction&& design)
+{
+    CutCoefficients result;
+
+    if( findCounted(key, result) )
+        return result;
+
+    result = design();
+    insert(key, result);
+
+    return result;
+}
+
+CoefficientCache::Key CoefficientCache::makePeakKey(const ChainSettings& chainSettings, double sampleRate)
+{
+    return { sampleRate, chainSettings.peakFreq, chainSettings.peakGainInDecibels, chainSettings.peakQuality, PeakType };
+}
+
+CoefficientCache::Key CoefficientCache::makeLowCutKey(const ChainSettings& chainSettings, double sampleRate)
+{
+    return { sampleRate, chainSettings.lowCutFreq, (float) chainSettings.lowCutSlope, (float) chainSettings.lowCutFamily, LowCutType };
+}
+
+CoefficientCache::Key CoefficientCache::makeHighCutKey(const ChainSettings& chainSettings, double sampleRate)
+{
+    return { sampleRate, chainSettings.highCutFreq, (float) chainSettings.highCutSlope, (float) chainSettings.highCutFamily, HighCutType };
+}
+
+BiquadCoefficients CoefficientCache::getPeakFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return lookup(makePeakKey(chainSettings, sampleRate), [&]
+    {
+        CutCoefficients peak;
+        peak.sections[0] = makePeakFilter(chainSettings, sampleRate);
+        peak.numSections = 1;
+        return peak;
+    })[0];
+}
+
+CutCoefficients CoefficientCache::getLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return lookup(makeLowCutKey(chainSettings, sampleRate), [&] { return makeLowCutFilter(chainSettings, sampleRate); });
+}
+
+CutCoefficients CoefficientCache::getHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return lookup(makeHighCutKey(chainSettings, sampleRate), [&] { return makeHighCutFilter(chainSettings, sampleRate); });
+}
+
+bool CoefficientCache::findPeakFilter(const ChainSettings& chainSettings, double sampleRate, BiquadCoefficients& result)
+{
+    CutCoefficients peak;
+
+    if( ! findCounted(makePeakKey(chainSettings, sampleRate), peak) )
+        return false;
+
+    result = peak[0];
+    return true;
+}
+
+bool CoefficientCache::findLowCutFilter(const ChainSettings& chainSettings, double sampleRate, CutCoefficients& result)
+{
+    return findCounted(makeLowCutKey(chainSettings, sampleRate), result);
+}
+
+bool CoefficientCache::findHighCutFilter(const ChainSettings& chainSettings, double sampleRate, CutCoefficients& result)
+{
+    return findCounted(makeHighCutKey(chainSettings, sampleRate), result);
+}
+
+void CoefficientCache::storePeakFilter(const ChainSettings& chainSettings, double sampleRate, const BiquadCoefficients& coefficients)
+{
+    CutCoefficients peak;
+    peak.sections[0] = coefficients;
+    peak.numSections = 1;
+
+    insert(makePeakKey(chainSettings, sampleRate), peak);
+}
+
+void CoefficientCache::storeLowCutFilter(const ChainSettings& chainSettings, double sampleRate, const CutCoefficients& coefficients)
+{
+    insert(makeLowCutKey(chainSettings, sampleRate), coefficients);
+}
+
+void CoefficientCache::storeHighCutFilter(const ChainSettings& chainSettings, double sampleRate, const CutCoefficients& coefficients)
+{
+    insert(makeHighCutKey(chainSettings, sampleRate), coefficients);
+}
+
+void CoefficientCache::prewarm(const ChainSettings& chainSettings, double sampleRate, int stepsEachSide)
+{
+    //frequencies are on a 1 Hz grid between 20 Hz and 20 kHz
+    auto neighbour = [](float frequency, int step)
+    {
+        return juce::jlimit(20.f, 20000.f, std::round(frequency) + (float) step);
+    };
+
+    for( int step = -stepsEachSide; step <= stepsEachSide; ++step )
+    {
+        auto settings = chainSettings;
+        settings.lowCutFreq = neighbour(chainSettings.lowCutFreq, step);
+        settings.highCutFreq = neighbour(chainSettings.highCutFreq, step);
+        settings.peakFreq = neighbour(chainSettings.peakFreq, step);
+
+        getLowCutFilter(settings, sampleRate);
+        getHighCutFilter(settings, sampleRate);
+        getPeakFilter(settings, sampleRate);
+    }
+}
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+    Process-wide cache of designed filter coefficients.
+
+    Every parameter is quantized (1 Hz, 0.5 dB, 0.5 Q, sixteen slopes, four families) so an
+    automation sweep keeps asking for the same designs over and over. All the
+    SimpleEq instances in the process share one bounded table of them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct CoefficientCache
+{
+    CoefficientCache();
+
+    //lookups are lock-free, a miss designs the filter and stores it
+    BiquadCoefficients getPeakFilter(const ChainSettings& chainSettings, double sampleRate);
+    CutCoefficients getLowCutFilter(const ChainSettings& chainSettings, double sampleRate);
+    CutCoefficients getHighCutFilter(const ChainSettings& chainSettings, double sampleRate);
+
+    //the same lookups without the design on a miss, for callers that design their misses
+    //together (BatchDesigner) and hand them back with the store functions
+    bool findPeakFilter(const ChainSettings& chainSettings, double sampleRate, BiquadCoefficients& result);
+    bool findLowCutFilter(const ChainSettings& chainSettings, double sampleRate, CutCoefficients& result);
+    bool findHighCutFilter(const ChainSettings& chainSettings, double sampleRate, CutCoefficients& result);
+
+    void storePeakFilter(const ChainSettings& chainSettings, double sampleRate, const BiquadCoefficients& coefficients);
+    void storeLowCutFilter(const ChainSettings& chainSettings, double sampleRate, const CutCoefficients& coefficients);
+    void storeHighCutFilter(const ChainSettings& chainSettings, double sampleRate, const CutCoefficients& coefficients);
+
+    //design the neighbourhood of the current settings ahead of time
+    //so the first moves of a sweep are already hits
+    void prewarm(const ChainSettings& chainSettings, double sampleRate, int stepsEachSide = 64);
+
+    int getNumHits() const { return hits.load(std::memory_order_relaxed); }
+    int getNumMisses() const { return misses.load(std::memory_order_relaxed); }
+
+private:
+    enum FilterType
+    {
+        PeakType,
+        LowCutType,
+        HighCutType
+    };
+
+    struct Key
+    {
+        double sampleRate { 0 };
+        float frequency { 0 }, first { 0 }, second { 0 };
+        int type { -1 };
+
+        bool operator==(const Key& other) const
+        {
+            return sampleRate == other.sampleRate && frequency == other.frequency
+                && first == other.first && second == other.second && type == other.type;
+        }
+    };
+
+    //a value kept as relaxed atomic words, so a reader racing the writer gets a torn copy
+    //(which the sequence check throws away) rather than undefined behaviour
+    template<typename Value>
+    struct AtomicWords
+    {
+        static_assert(std::is_trivially_copyable<Value>::value, "copied through memcpy");
+
+        static constexpr size_t numWords = (sizeof(Value) + sizeof(juce::uint32) - 1) / sizeof(juce::uint32);
+
+        AtomicWords() noexcept { store(Value {}); }
+
+        void store(const Value& value) noexcept
+        {
+            std::array<juce::uint32, numWords> copy {};
+            std::memcpy(copy.data(), &value, sizeof(Value));
+
+            for( size_t i = 0; i < numWords; ++i )
+                words[i].store(copy[i], std::memory_order_relaxed);
+        }
+
+        Value load() const noexcept
+        {
+            std::array<juce::uint32, numWords> copy;
+
+            for( size_t i = 0; i < numWords; ++i )
+                copy[i] = words[i].load(std::memory_order_relaxed);
+
+            //trivially copyable, only the default member initialisers make gcc warn
+            Value value;
+            std::memcpy(static_cast<void*>(&value), copy.data(), sizeof(Value));
+            return value;
+        }
+
+        std::array<std::atomic<juce::uint32>, numWords> words;
+    };
+
+    //sequence is odd while an entry is being rewritten, readers retry or skip it
+    struct Entry
+    {
+        std::atomic<juce::uint32> sequence { 0 };
+        std::atomic<juce::uint32> lastUsed { 0 };
+        AtomicWords<Key> key;
+        AtomicWords<CutCoefficients> coefficients;
+    };
+
+    static constexpr int numWays = 4;
+    static constexpr int numSets = 1024;
+
+    struct Set
+    {
+        std::atomic_flag writeLock = ATOMIC_FLAG_INIT;
+        std::array<Entry, numWays> ways;
+    };
+
+    std::unique_ptr<Set[]> sets;
+    std::atomic<juce::uint32> clock { 1 };
+    std::atomic<int> hits { 0 }, misses { 0 };
+
+    static size_t hashKey(const Key& key);
+
+    static Key makePeakKey(const ChainSettings& chainSettings, double sampleRate);
+    static Key makeLowCutKey(const ChainSettings& chainSettings, double sampleRate);
+    static Key makeHighCutKey(const ChainSettings& chainSettings, double sampleRate);
+
+    bool findCounted(const Key& key, CutCoefficients& result);
+
+    bool find(const Key& key, CutCoefficients& result);
+    void insert(const Key& key, const CutCoefficients& coefficients);
+
+    template<typename DesignFunction>
+    CutCoefficients lookup(const Key& key, DesignFunction&& design);
+
+    JUCE_DECLARE_NON_COPYABLE(CoefficientCache)
+};
@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    CutPrototype.cpp
+    Analog lowpass prototypes of the cut filter families.
+
+  ==============================================================================
+*/
+
+#include "CutPrototype.h"
+
+using Pole = std::complex<double>;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  the left half plane poles of each family, one of every conjugate pair is enough
+
+static std::vector<Pole> getButterworthPoles(int order)
+{
+    std::vector<Pole> poles;
+
+    for( int k = 0; k < order; ++k )
+    {
+        auto angle = juce::MathConstants<double>::pi * (2.0 * k + 1.0) / (2.0 * order);
+        poles.push_back({ -std::sin(angle), std::cos(angle) });
+    }
+
+    return poles;
+}
+
+static std::vector<Pole> getChebyshevPoles(int order, double rippleDb)
+{
+    auto epsilon = std::sqrt(std::pow(10.0, rippleDb / 10.0) - 1.0);
+    auto v = std::asinh(1.0 / epsilon) / order;
+    std::vector<Pole> poles;
+
+    for( int k = 0; k < order; ++k )
+    {
+        auto angle = juce::MathConstants<double>::pi * (2.0 * k + 1.0) / (2.0 * order);
+        poles.push_back({ -std::sinh(v) * std::sin(angle), std::cosh(v) * std::cos(angle) });
+    }
+
+    return poles;
+}
+
+//roots of the reverse bessel polynomial, then scaled so the magnitude is -3 dB at 1 rad/s
+static std::vector<Pole> getBesselPoles(int order)
+{
+    //coefficients of s^k, (2n - k)! / (2^(n - k) k! (n - k)!), monic at k = n
+    std::vector<double> polynomial((size_t) order + 1);
+
+    for( int k = 0; k <= order; ++k )
+        polynomial[(size_t) k] = std::exp(std::lgamma(2.0 * order - k + 1.0) - (order - k) * std::log(2.0)
+                                          - std::lgamma(k + 1.0) - std::lgamma(order - k + 1.0));
+
+    auto evaluate = [&](Pole s)
+    {
+        Pole result = 0.0;
+
+        for( int k = order; k >= 0; --k )
+            result = result * s + polynomial[(size_t) k];
+
+        return result;
+    };
+
+    //durand-kerner, started on a spiral around the magnitude of the roots
+    std::vector<Pole> poles((size_t) order);
+    auto radius = std::pow(polynomial[0], 1.0 / order);
+
+    for( int i = 0; i < order; ++i )
+        poles[(size_t) i] = radius * std::pow(Pole(0.4, 0.9), i);
+
+    for( int iteration = 0; iteration < 500; ++iteration )
+    {
+        for( size_t i = 0; i < poles.size(); ++i )
+        {
+            Pole denominator = 1.0;
+
+            for( size_t j = 0; j < poles.size(); ++j )
+                if( j != i )
+                    denominator *= poles[i] - poles[j];
+
+            poles[i] -= evaluate(poles[i]) / denominator;
+        }
+    }
+
+    auto powerGain = [&](double w)
+    {
+        double gain = 1.0;
+
+        for( auto& pole : poles )
+            gain *= std::norm(pole) / std::norm(Pole(0.0, w) - pole);
+
+        return gain;
+    };
+
+    //the magnitude only falls with frequency, bisect for the half power point
+    double low = 0.01, high = 100.0;
+
+    for( int iteration = 0; iteration < 100; ++iteration )
+    {
+        auto middle = std::sqrt(low * high);
+        (powerGain(middle) > 0.5 ? low : high) = middle;
+    }
+
+    for( auto& pole : poles )
+        pole /= low;
+
+    return poles;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+static CutPrototype makePrototype(const std::vector<Pole>& poles)
+{
+    CutPrototype prototype;
+    std::vector<double> realPoles;
+
+    auto add = [&](PrototypeSection section)
+    {
+        jassert(prototype.numSections < maxCutSections);
+        prototype.sections[(size_t) prototype.numSections++] = section;
+    };
+
+    for( auto& pole : poles )
+    {
+        if( std::abs(pole.imag()) <= 1e-9 )
+            realPoles.push_back(-pole.real());
+        else if( pole.imag() > 0.0 )    //the other half of the pair is implied
+            add({ std::abs(pole), std::abs(pole) / (-2.0 * pole.real()) });
+    }
+
+    //two real poles make one second order section, a doubled pole is a Q of 0.5
+    for( size_t i = 0; i + 1 < realPoles.size(); i += 2 )
+    {
+        auto frequency = std::sqrt(realPoles[i] * realPoles[i + 1]);
+        add({ frequency, frequency / (realPoles[i] + realPoles[i + 1]) });
+    }
+
+    if( realPoles.size() % 2 != 0 )
+        add({ realPoles.back(), 0.0 });
+
+    //low Q sections first, so the resonant ones see an already filtered signal
+    std::sort(prototype.sections.begin(), prototype.sections.begin() + prototype.numSections,
+              [](const PrototypeSection& a, const PrototypeSection& b) { return a.quality < b.quality; });
+
+    return prototype;
+}
+
+static CutPrototype makePrototype(CutFamily family, int order)
+{
+    static constexpr double chebyshevRippleDb = 0.5;
+
+    if( family == LinkwitzRiley && order % 2 == 0 )
+    {
+        //every butterworth pole twice
+        auto poles = getButterworthPoles(order / 2);
+        auto doubled = poles;
+        doubled.insert(doubled.end(), poles.begin(), poles.end());
+
+        return makePrototype(doubled);
+    }
+
+    if( family == Bessel )
+        return makePrototype(getBesselPoles(order));
+
+    if( family == Chebyshev )
+    {
+        auto prototype = makePrototype(getChebyshevPoles(order, chebyshevRippleDb));
+
+        if( order % 2 == 0 )
+            prototype.gain = 1.0 / std::sqrt(std::pow(10.0, chebyshevRippleDb / 10.0));
+
+        return prototype;
+    }
+
+    return makePrototype(getButterworthPoles(order));
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+const CutPrototype& getCutPrototype(CutFamily family, int order)
+{
+    static constexpr int numFamilies = 4;
+    static constexpr int maxOrder = 2 * maxCutSections;
+    using Table = std::array<std::array<CutPrototype, maxOrder>, numFamilies>;
+
+    //thread safe static init, only ever read afterwards
+    static const Table table = []
+    {
+        Table result;
+
+        for( int family = 0; family < numFamilies; ++family )
+            for( int order = 1; order <= maxOrder; ++order )
+                result[(size_t) family][(size_t) order - 1] = makePrototype(static_cast<CutFamily>(family), order);
+
+        return result;
+    }();
+
+    jassert(order >= 1 && order <= maxOrder);
+    return table[(size_t) family][(size_t) juce::jlimit(1, maxOrder, order) - 1];
+}
+
+std::array<double, 6> designCutSection(const PrototypeSection& section, double gain,
+                                       double frequency, double sampleRate, bool isHighPass)
+{
+    //s -> 1 / s for the highpass, the pole frequency scales the other way
+    auto K = std::tan(juce::MathConstants<double>::pi * juce::jmin(frequency / sampleRate, 0.49));
+    auto W = (isHighPass ? 1.0 / section.frequency : section.frequency) * K;
+    std::array<double, 6> c;
+
+    if( section.quality == 0.0 )
+    {
+        auto a0 = 1.0 + W;
+        c = { isHighPass ? 1.0 : W, isHighPass ? -1.0 : W, 0.0, a0, W - 1.0, 0.0 };
+    }
+    else
+    {
+        auto W2 = W * W;
+        auto a0 = 1.0 + W / section.quality + W2;
+        c = { isHighPass ? 1.0 : W2, isHighPass ? -2.0 : 2.0 * W2, isHighPass ? 1.0 : W2,
+              a0, 2.0 * (W2 - 1.0), 1.0 - W / section.quality + W2 };
+    }
+
+    auto a0 = c[3];
+
+    for( auto& coefficient : c )
+        coefficient /= a0;
+
+    c[0] *= gain;
+    c[1] *= gain;
+    c[2] *= gain;
+
+    return c;
+}
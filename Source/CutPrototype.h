@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+
+    CutPrototype.h
+    Analog lowpass prototypes of the cut filter families.
+
+    Every family and order is factored into second order sections (and one
+    first order section for odd orders), normalised to a 1 rad/s cutoff. The
+    digital sections are then a bilinear transform of each, prewarped at the
+    cutoff so the whole cascade keeps its shape right up to nyquist.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//16th order, 96 dB/Oct
+constexpr int maxCutSections = 8;
+
+enum CutFamily
+{
+    Butterworth,
+    LinkwitzRiley,      //butterworth squared, -6 dB at the cutoff, even orders only
+    Bessel,             //flattest group delay, -3 dB at the cutoff
+    Chebyshev           //0.5 dB passband ripple
+};
+
+//one pole pair at frequency (rad/s) with the given Q, or a single real pole at frequency when quality is 0
+struct PrototypeSection
+{
+    double frequency { 1.0 };
+    double quality { 0.0 };
+};
+
+struct CutPrototype
+{
+    std::array<PrototypeSection, maxCutSections> sections {};
+    int numSections { 0 };
+
+    //goes on the first section, the even order chebyshevs start at the bottom of the ripple
+    double gain { 1.0 };
+};
+
+//worked out once for every family and order on first use, lowest Q first.
+//orders are 1 to 2 * maxCutSections, odd linkwitz-riley orders are plain butterworth
+const CutPrototype& getCutPrototype(CutFamily family, int order);
+
+//{ b0, b1, b2, a0, a1, a2 } of one section, normalised so a0 is 1
+std::array<double, 6> designCutSection(const PrototypeSection& section, double gain,
+                                       double frequency, double sampleRate, bool isHighPass);
@@ -0,0 +1,365 @@
+/*
+  ==============================================================================
+
+    FilterKernels.cpp
+    The biquad section layout and the loops that run a cascade of them.
+
+  ==============================================================================
+*/
+
+#include "FilterKernels.h"
+
+//target attributes and vector extensions are a gcc / clang thing, msvc builds get the generic loop only
+#if JUCE_INTEL && (JUCE_GCC || JUCE_CLANG)
+ #define SIMPLEEQ_ISA_KERNELS 1
+#else
+ #define SIMPLEEQ_ISA_KERNELS 0
+#endif
+
+//gcc contracts a * b + c across statements whenever fma is in the target, clang only within
+//an expression and the lane loop never writes one that way. either would round differently
+//from the generic loop and fail the gate for no gain in a latency bound recursion
+#if JUCE_GCC && ! JUCE_CLANG
+ #define SIMPLEEQ_NO_CONTRACTION __attribute__((optimize("fp-contract=off")))
+#else
+ #define SIMPLEEQ_NO_CONTRACTION
+#endif
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void BiquadSection::setCoefficients(const BiquadCoefficients& c) noexcept
+{
+    auto a0 = c[3];
+
+    b0 = c[0] / a0;
+    b1 = c[1] / a0;
+    b2 = c[2] / a0;
+    a1 = c[4] / a0;
+    a2 = c[5] / a0;
+}
+
+void BiquadState::snapToZero() noexcept
+{
+    juce::dsp::util::snapToZero(s1);
+    juce::dsp::util::snapToZero(s2);
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  the generic loop, one lane at a time
+template<int NumSections>
+static forcedinline void processSections(const BiquadSection* sections, BiquadState* states, float* samples, int numSamples) noexcept
+{
+    //local copies the compiler can keep in registers for the whole block
+    std::array<BiquadSection, NumSections> local;
+    std::array<BiquadState, NumSections> localStates;
+    std::copy(sections, sections + NumSections, local.begin());
+    std::copy(states, states + NumSections, localStates.begin());
+
+    for( int i = 0; i < numSamples; ++i )
+    {
+        auto sample = samples[i];
+
+        for( size_t s = 0; s < (size_t) NumSections; ++s )
+            sample = local[s].processSample(localStates[s], sample);
+
+        samples[i] = sample;
+    }
+
+    std::copy(localStates.begin(), localStates.end(), states);
+}
+
+//instantiated for every section count, a 12 dB/Oct cut runs one biquad and pays nothing for the other seven
+static void processCascade(const BiquadSection* sections, BiquadState* states, int numSections, float* samples, int numSamples) noexcept
+{
+    switch( numSections )
+    {
+        case 0: break;
+        case 1: processSections<1>(sections, states, samples, numSamples); break;
+        case 2: processSections<2>(sections, states, samples, numSamples); break;
+        case 3: processSections<3>(sections, states, samples, numSamples); break;
+        case 4: processSections<4>(sections, states, samples, numSamples); break;
+        case 5: processSections<5>(sections, states, samples, numSamples); break;
+        case 6: processSections<6>(sections, states, samples, numSamples); break;
+        case 7: processSections<7>(sections, states, samples, numSamples); break;
+        case 8: processSections<8>(sections, states, samples, numSamples); break;
+        default: jassertfalse; break;
+    }
+}
+
+static void processGeneric(const FilterKernels::Lane* lanes, int numLanes, int numSamples) noexcept
+{
+    using namespace FilterKernels;
+
+    for( int l = 0; l < numLanes; ++l )
+    {
+        auto& lane = lanes[l];
+        processCascade(lane.sections, lane.states, lane.numLowCutSections, lane.samples, numSamples);
+        processCascade(lane.sections + peakSlot, lane.states + peakSlot, 1, lane.samples, numSamples);
+        processCascade(lane.sections + highCutSlot, lane.states + highCutSlot, lane.numHighCutSections, lane.samples, numSamples);
+    }
+}
+
+#if SIMPLEEQ_ISA_KERNELS
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  the wide loops, Width lanes side by side with one vector element each. every slot any of
+//  the lanes runs is run for all of them, a lane whose cut is shorter passes straight through
+//  the extra ones. force inlined into each variant below, so every copy gets compiled with
+//  that variant's instruction set
+template<int Width>
+struct LaneVector
+{
+    typedef float Type __attribute__((vector_size(Width * sizeof(float))));
+};
+
+template<int Width>
+static forcedinline void processLaneGroup(const FilterKernels::Lane* lanes, int numLanes, int numSamples) noexcept
+{
+    using namespace FilterKernels;
+    using Vector = typename LaneVector<Width>::Type;
+
+    //samples go through in chunks, transposed so each vector holds one sample of every lane
+    constexpr int chunkSize = 32;
+
+    int numLowCutSections = 0, numHighCutSections = 0;
+
+    for( int l = 0; l < numLanes; ++l )
+    {
+        numLowCutSections = juce::jmax(numLowCutSections, lanes[l].numLowCutSections);
+        numHighCutSections = juce::jmax(numHighCutSections, lanes[l].numHighCutSections);
+    }
+
+    auto isRunning = [](const Lane& lane, int slot)
+    {
+        return slot < lane.numLowCutSections || slot == peakSlot
+            || (slot >= highCutSlot && slot < highCutSlot + lane.numHighCutSections);
+    };
+
+    std::array<int, numSlots> slots;
+    int numActive = 0;
+
+    for( int s = 0; s < numLowCutSections; ++s )
+        slots[(size_t) numActive++] = s;
+
+    slots[(size_t) numActive++] = peakSlot;
+
+    for( int s = 0; s < numHighCutSections; ++s )
+        slots[(size_t) numActive++] = highCutSlot + s;
+
+    //coefficients and state gathered once per block, lanes that don't run a slot get a pass through
+    std::array<Vector, numSlots> b0, b1, b2, a1, a2, s1, s2;
+
+    for( int k = 0; k < numActive; ++k )
+    {
+        auto slot = slots[(size_t) k];
+
+        for( int l = 0; l < Width; ++l )
+        {
+            auto running = l < numLanes && isRunning(lanes[l], slot);
+            auto section = running ? lanes[l].sections[slot] : BiquadSection();
+            auto state = running ? lanes[l].states[slot] : BiquadState();
+
+            b0[(size_t) k][l] = section.b0;
+            b1[(size_t) k][l] = section.b1;
+            b2[(size_t) k][l] = section.b2;
+            a1[(size_t) k][l] = section.a1;
+            a2[(size_t) k][l] = section.a2;
+            s1[(size_t) k][l] = state.s1;
+            s2[(size_t) k][l] = state.s2;
+        }
+    }
+
+    std::array<Vector, chunkSize> chunk;
+
+    for( int start = 0; start < numSamples; start += chunkSize )
+    {
+        auto numInChunk = juce::jmin(chunkSize, numSamples - start);
+
+        for( int i = 0; i < numInChunk; ++i )
+            for( int l = 0; l < Width; ++l )
+                chunk[(size_t) i][l] = l < numLanes ? lanes[l].samples[start + i] : 0.f;
+
+        //a section at a time over the chunk, so its coefficients and state stay in registers.
+        //written out op by op in the same order as BiquadSection::processSample
+        for( size_t k = 0; k < (size_t) numActive; ++k )
+        {
+            auto vb0 = b0[k], vb1 = b1[k], vb2 = b2[k], va1 = a1[k], va2 = a2[k];
+            auto vs1 = s1[k], vs2 = s2[k];
+
+            for( size_t i = 0; i < (size_t) numInChunk; ++i )
+            {
+                auto x = chunk[i];
+                Vector y = vb0 * x;
+                y = y + vs1;
+
+                Vector forward = vb1 * x;
+                Vector feedback = va1 * y;
+                vs1 = forward - feedback;
+                vs1 = vs1 + vs2;
+
+                forward = vb2 * x;
+                feedback = va2 * y;
+                vs2 = forward - feedback;
+
+                chunk[i] = y;
+            }
+
+            s1[k] = vs1;
+            s2[k] = vs2;
+        }
+
+        for( int l = 0; l < numLanes; ++l )
+            for( int i = 0; i < numInChunk; ++i )
+                lanes[l].samples[start + i] = chunk[(size_t) i][l];
+    }
+
+    for( int k = 0; k < numActive; ++k )
+    {
+        auto slot = slots[(size_t) k];
+
+        for( int l = 0; l < numLanes; ++l )
+        {
+            if( ! isRunning(lanes[l], slot) )
+                continue;
+
+            lanes[l].states[slot] = { s1[(size_t) k][l], s2[(size_t) k][l] };
+        }
+    }
+}
+
+//a stereo pair doesn't need the full width, the narrower vector does it with less to shuffle.
+//a lane on its own gains nothing from the transposes, it takes the generic loop
+template<int Width>
+static forcedinline void processLanes(const FilterKernels::Lane* lanes, int numLanes, int numSamples) noexcept
+{
+    for( int first = 0; first < numLanes; first += Width )
+    {
+        auto numInGroup = juce::jmin(Width, numLanes - first);
+
+        if( numInGroup == 1 )
+            processGeneric(lanes + first, 1, numSamples);
+        else if( numInGroup <= 4 )
+            processLaneGroup<4>(lanes + first, numInGroup, numSamples);
+        else if( Width > 8 && numInGroup <= 8 )
+            processLaneGroup<8>(lanes + first, numInGroup, numSamples);
+        else
+            processLaneGroup<Width>(lanes + first, numInGroup, numSamples);
+    }
+}
+
+__attribute__((target("avx2"))) SIMPLEEQ_NO_CONTRACTION
+static void processAvx2(const FilterKernels::Lane* lanes, int numLanes, int numSamples) noexcept
+{
+    processLanes<8>(lanes, numLanes, numSamples);
+}
+
+__attribute__((target("avx512f,avx512vl,avx2"))) SIMPLEEQ_NO_CONTRACTION
+static void processAvx512(const FilterKernels::Lane* lanes, int numLanes, int numSamples) noexcept
+{
+    processLanes<16>(lanes, numLanes, numSamples);
+}
+#endif
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+namespace FilterKernels
+{
+
+static std::atomic<int> forcedVariant { NumVariants };
+
+Kernel getKernel(Variant variant)
+{
+   #if SIMPLEEQ_ISA_KERNELS
+    if( variant == Avx2 )
+        return processAvx2;
+    if( variant == Avx512 )
+        return processAvx512;
+   #endif
+
+    jassert(variant == Generic);
+    return processGeneric;
+}
+
+int getLaneWidth(Variant variant)
+{
+    switch( variant )
+    {
+        case Avx2: return 8;
+        case Avx512: return 16;
+        default: return 1;
+    }
+}
+
+const char* getName(Variant variant)
+{
+    switch( variant )
+    {
+        case Avx2: return "avx2";
+        case Avx512: return "avx512";
+        default: return "generic";
+    }
+}
+
+bool isSupported(Variant variant)
+{
+    if( variant == Generic )
+        return true;
+
+   #if SIMPLEEQ_ISA_KERNELS
+    //juce checks cpuid, and that the os saves the wide registers
+    if( variant == Avx2 )
+        return juce::SystemStats::hasAVX2();
+    if( variant == Avx512 )
+        return juce::SystemStats::hasAVX512F() && juce::SystemStats::hasAVX512VL() && isSupported(Avx2);
+   #endif
+
+    return false;
+}
+
+Variant findVariant(const juce::String& name)
+{
+    for( int v = 0; v < NumVariants; ++v )
+        if( name.trim().equalsIgnoreCase(getName(static_cast<Variant>(v))) )
+            return static_cast<Variant>(v);
+
+    return NumVariants;
+}
+
+void forceVariant(Variant variant)
+{
+    forcedVariant.store(variant);
+}
+
+Variant getSelectedVariant(bool (*isAllowed)(Variant))
+{
+    //read once, it's for a whole session of A/B testing
+    static const Variant fromEnvironment = findVariant(juce::SystemStats::getEnvironmentVariable("SIMPLEEQ_KERNEL", {}));
+
+    auto canRun = [isAllowed] (Variant variant)
+    {
+        return isSupported(variant) && (variant == Generic || isAllowed == nullptr || isAllowed(variant));
+    };
+
+    //the runners force a kernel to measure that kernel, so the gate doesn't apply
+    auto forced = static_cast<Variant>(forcedVariant.load());
+
+    if( forced != NumVariants )
+    {
+        if( isSupported(forced) )
+            return forced;
+
+        DBG("kernel " << getName(forced) << " isn't supported here, picking one instead");
+    }
+    else if( fromEnvironment != NumVariants )
+    {
+        if( canRun(fromEnvironment) )
+            return fromEnvironment;
+
+        DBG("kernel " << getName(fromEnvironment) << " isn't supported or didn't pass here, picking one instead");
+    }
+
+    for( int v = NumVariants - 1; v > Generic; --v )
+        if( canRun(static_cast<Variant>(v)) )
+            return static_cast<Variant>(v);
+
+    return Generic;
+}
+
+}
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    FilterKernels.h
+    The biquad section layout and the loops that run a cascade of them.
+
+    A kernel runs whole chains ("lanes"), each over its own channel. The
+    generic one runs them one after another with the scalar loop. On x86
+    with gcc or clang there are two more: AVX2 runs 8 chains side by side,
+    one per vector element, and AVX-512 runs 16, so a stereo pair or a wide
+    bus goes through the recursion once instead of once per channel. They
+    don't contract into fused multiply-adds, every lane comes out bit for
+    bit the same as the generic loop.
+
+    The best one the CPU has and the AccuracyGate passed is picked at
+    runtime, set SIMPLEEQ_KERNEL=generic|avx2|avx512 to ask for one for
+    A/B tests.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//raw biquad coefficients { b0, b1, b2, a0, a1, a2 }
+//designing into these doesn't touch the heap, so it's safe to do mid block
+using BiquadCoefficients = std::array<float, 6>;
+
+//what a section remembers between samples, kept apart from the coefficients
+//so chains running the same filters can share one copy of those
+struct BiquadState
+{
+    float s1 { 0.f }, s2 { 0.f };
+
+    void reset() noexcept { s1 = s2 = 0.f; }
+    void snapToZero() noexcept;
+};
+
+//  transposed direct form II, same as the juce filters.
+//  coefficients normalised (a0 is 1), padded to 32 bytes so none straddles a cache line
+struct alignas(32) BiquadSection
+{
+    float b0 { 1.f }, b1 { 0.f }, b2 { 0.f }, a1 { 0.f }, a2 { 0.f };
+
+    void setCoefficients(const BiquadCoefficients& c) noexcept;
+    BiquadCoefficients getCoefficients() const noexcept { return { b0, b1, b2, 1.f, a1, a2 }; }
+
+    inline float processSample(BiquadState& state, float x) const noexcept
+    {
+        auto y = b0 * x + state.s1;
+        state.s1 = b1 * x - a1 * y + state.s2;
+        state.s2 = b2 * x - a2 * y;
+        return y;
+    }
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+namespace FilterKernels
+{
+    //the longest cut a kernel takes
+    constexpr int maxSections = 8;
+
+    //a chain's sections sit at fixed slots: the low cut's from 0, the bell at peakSlot and the
+    //high cut's from highCutSlot, so chains running different orders still line up slot for slot
+    constexpr int peakSlot = maxSections;
+    constexpr int highCutSlot = maxSections + 1;
+    constexpr int numSlots = 2 * maxSections + 1;
+
+    //one chain for a kernel to run in place. sections (numSlots of them, maybe shared with other
+    //lanes) and states are both slot indexed, only the slots the two cut orders use are read
+    struct Lane
+    {
+        const BiquadSection* sections;
+        BiquadState* states;
+        int numLowCutSections, numHighCutSections;
+        float* samples;
+    };
+
+    //the most lanes a kernel takes in one call
+    constexpr int maxLanes = 16;
+
+    enum Variant
+    {
+        Generic,
+        Avx2,
+        Avx512,
+        NumVariants
+    };
+
+    //runs every lane's chain over its samples. the state isn't snapped to zero, a caller that
+    //splits its block over several calls does that once at the end like the others
+    using Kernel = void (*)(const Lane* lanes, int numLanes, int numSamples) noexcept;
+
+    Kernel getKernel(Variant variant);
+
+    //how many lanes the variant runs side by side, callers with more chains than that hand them
+    //over in runs of this many
+    int getLaneWidth(Variant variant);
+
+    const char* getName(Variant variant);
+
+    //built into this binary and runnable on this CPU
+    bool isSupported(Variant variant);
+
+    //the fastest supported one isAllowed lets through, unless SIMPLEEQ_KERNEL (or forceVariant) asks
+    //for another. SIMPLEEQ_KERNEL is held to isAllowed too, generic doesn't need to be allowed
+    Variant getSelectedVariant(bool (*isAllowed)(Variant) = nullptr);
+
+    //process-wide override for the runners, skips isAllowed. NumVariants goes back to the automatic choice
+    void forceVariant(Variant variant);
+
+    //by name, as in SIMPLEEQ_KERNEL. NumVariants if it isn't one
+    Variant findVariant(const juce::String& name);
+}
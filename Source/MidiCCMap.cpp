@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    MidiCCMap.cpp
+    Maps incoming MIDI controller messages onto the EQ parameters.
+
+  ==============================================================================
+*/
+
+#include "MidiCCMap.h"
+#include "PluginProcessor.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+MidiCCMap::MidiCCMap(juce::AudioProcessorValueTreeState& apvts)
+{
+    //the set 0 parameter behind each MappedParameter
+    static constexpr Parameters::Index indices[NumPerSet] =
+    {
+        Parameters::LowCutFreq, Parameters::HighCutFreq, Parameters::PeakFreq, Parameters::PeakGain, Parameters::PeakQuality,
+        Parameters::LowCutSlope, Parameters::HighCutSlope
+    };
+
+    for( int set = 0; set < 2; ++set )
+    {
+        for( int i = 0; i < NumPerSet; ++i )
+            parameters[(size_t) inSet(static_cast<MappedParameter>(i), set)] = apvts.getParameter(Parameters::getID(Parameters::inSet(indices[i], set)));
+    }
+
+    controllerToParameter.fill(-1);
+
+    //undefined controllers by default so we don't fight with mod wheel, volume etc.
+    //20-26 for the first set, 102-108 for R/S
+    for( int i = 0; i < NumPerSet; ++i )
+    {
+        setController(static_cast<MappedParameter>(i), 20 + i);
+        setController(inSet(static_cast<MappedParameter>(i), 1), 102 + i);
+    }
+}
+
+void MidiCCMap::prepare(double sampleRate)
+{
+    releaseSamples = juce::roundToInt(0.25 * sampleRate);
+}
+
+void MidiCCMap::setController(MappedParameter parameter, int controllerNumber)
+{
+    for( auto& mapped : controllerToParameter )
+    {
+        if( mapped == parameter )
+            mapped = -1;
+    }
+
+    if( juce::isPositiveAndBelow(controllerNumber, 128) )
+        controllerToParameter[(size_t) controllerNumber] = parameter;
+}
+
+int MidiCCMap::getController(MappedParameter parameter) const
+{
+    for( size_t cc = 0; cc < controllerToParameter.size(); ++cc )
+    {
+        if( controllerToParameter[cc] == parameter )
+            return (int) cc;
+    }
+
+    return -1;
+}
+
+int MidiCCMap::apply(const juce::MidiMessage& message, std::array<ChainSettings, 2>& chainSettings)
+{
+    if( ! message.isController() )
+        return 0;
+
+    auto index = controllerToParameter[(size_t) message.getControllerNumber()];
+
+    if( index < 0 )
+        return 0;
+
+    auto* param = parameters[(size_t) index];
+    auto normalised = message.getControllerValue() / 127.f;
+    //convertFrom0to1 snaps to the parameter interval, same as the knobs
+    auto value = param->convertFrom0to1(normalised);
+
+    pendingValues[(size_t) index] = param->convertTo0to1(value);
+    pendingMask |= 1 << index;
+
+    auto parameterSet = index / NumPerSet;
+    auto& settings = chainSettings[(size_t) parameterSet];
+    auto bandBit = [parameterSet](ChainPositions position) { return 1 << (position + parameterSet * NumChainPositions); };
+
+    switch( index % NumPerSet )
+    {
+        case LowCutFreq:
+            settings.lowCutFreq = value;
+            return bandBit(ChainPositions::LowCut);
+        case HighCutFreq:
+            settings.highCutFreq = value;
+            return bandBit(ChainPositions::HighCut);
+        case PeakFreq:
+            settings.peakFreq = value;
+            return bandBit(ChainPositions::Peak);
+        case PeakGain:
+            settings.peakGainInDecibels = value;
+            return bandBit(ChainPositions::Peak);
+        case PeakQuality:
+            settings.peakQuality = value;
+            return bandBit(ChainPositions::Peak);
+        case LowCutSlope:
+            settings.lowCutSlope = static_cast<Slope>(juce::roundToInt(value));
+            return bandBit(ChainPositions::LowCut);
+        case HighCutSlope:
+            settings.highCutSlope = static_cast<Slope>(juce::roundToInt(value));
+            return bandBit(ChainPositions::HighCut);
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+void MidiCCMap::publishChanges(int numSamples)
+{
+    if( (pendingMask | touchedMask) == 0 )
+        return;
+
+    for( int i = 0; i < NumMappedParameters; ++i )
+    {
+        auto bit = 1 << i;
+        auto* param = parameters[(size_t) i];
+
+        if( pendingMask & bit )
+        {
+            if( ! (touchedMask & bit) )
+                param->beginChangeGesture();
+
+            param->setValueNotifyingHost(pendingValues[(size_t) i]);
+            samplesSinceChange[(size_t) i] = 0;
+            touchedMask |= bit;
+        }
+        else if( touchedMask & bit )
+        {
+            samplesSinceChange[(size_t) i] += numSamples;
+
+            if( samplesSinceChange[(size_t) i] >= releaseSamples )
+            {
+                param->endChangeGesture();
+                touchedMask &= ~bit;
+            }
+        }
+    }
+
+    pendingMask = 0;
+}
+
+void MidiCCMap::endGestures()
+{
+    for( int i = 0; i < NumMappedParameters; ++i )
+    {
+        if( touchedMask & (1 << i) )
+            parameters[(size_t) i]->endChangeGesture();
+    }
+
+    touchedMask = 0;
+}
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    MidiCCMap.h
+    Maps incoming MIDI controller messages onto the EQ parameters.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct ChainSettings;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct MidiCCMap
+{
+    enum MappedParameter
+    {
+        LowCutFreq,
+        HighCutFreq,
+        PeakFreq,
+        PeakGain,
+        PeakQuality,
+        LowCutSlope,
+        HighCutSlope,
+
+        //the R/S set is the same again, offset by NumPerSet like Parameters::inSet
+        NumPerSet,
+
+        NumMappedParameters = 2 * NumPerSet
+    };
+
+    static constexpr MappedParameter inSet(MappedParameter parameter, int parameterSet)
+    {
+        return static_cast<MappedParameter>(parameter + parameterSet * NumPerSet);
+    }
+
+    explicit MidiCCMap(juce::AudioProcessorValueTreeState& apvts);
+
+    //how long a controller has to sit still before its gesture ends
+    void prepare(double sampleRate);
+
+    //assign a controller number (0-127) to a parameter, -1 removes the mapping
+    void setController(MappedParameter parameter, int controllerNumber);
+    int getController(MappedParameter parameter) const;
+
+    //writes the controller value into the settings of its set
+    //returns the bit of the band it touched, ChainPositions shifted up by NumChainPositions
+    //for the second set, 0 if the message isn't mapped
+    int apply(const juce::MidiMessage& message, std::array<ChainSettings, 2>& settings);
+
+    //hand the values the controllers set during the block back to the apvts
+    //so the next block, the GUI and the host all agree with what we played.
+    //called once per block, numSamples long, whether anything moved or not
+    void publishChanges(int numSamples);
+
+    //closes any gesture still open, for when the audio stops
+    void endGestures();
+
+private:
+    std::array<juce::RangedAudioParameter*, NumMappedParameters> parameters;
+    std::array<int, 128> controllerToParameter;
+
+    std::array<float, NumMappedParameters> pendingValues {};
+    int pendingMask { 0 };
+
+    //a controller being moved is a gesture, like a knob being held, so touch and latch
+    //automation record it. it ends once the controller has been still for releaseSamples
+    std::array<int, NumMappedParameters> samplesSinceChange {};
+    int touchedMask { 0 };
+    int releaseSamples { 11025 };
+};
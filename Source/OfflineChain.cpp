@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    OfflineChain.cpp
+    The chain the biquad engine runs while the host renders offline.
+
+  ==============================================================================
+*/
+
+#include "OfflineChain.h"
+#include "PluginProcessor.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void OfflineChain::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    lowCutFreq.reset(sampleRate, 0.02);
+    highCutFreq.reset(sampleRate, 0.02);
+    peakFreq.reset(sampleRate, 0.02);
+    peakGain.reset(sampleRate, 0.02);
+    peakQuality.reset(sampleRate, 0.02);
+
+    skipSmoothing();
+    reset();
+}
+
+void OfflineChain::setTargets(const ChainSettings& chainSettings)
+{
+    lowCutFreq.setTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setTargetValue(chainSettings.highCutFreq);
+    peakFreq.setTargetValue(chainSettings.peakFreq);
+    peakGain.setTargetValue(chainSettings.peakGainInDecibels);
+    peakQuality.setTargetValue(chainSettings.peakQuality);
+
+    auto* newLowCut = &getCutPrototype(chainSettings.lowCutFamily, getCutFilterOrder(chainSettings.lowCutSlope));
+    auto* newHighCut = &getCutPrototype(chainSettings.highCutFamily, getCutFilterOrder(chainSettings.highCutSlope));
+
+    if( newLowCut == lowCutPrototype && newHighCut == highCutPrototype )
+        return;
+
+    //the bell and the high cut move along with the low cut's length, each keeps its own state
+    auto previous = sections;
+
+    for( int s = 0; s < newLowCut->numSections; ++s )
+        sections[(size_t) s] = s < numLowCutSections ? previous[(size_t) s] : Section {};
+
+    sections[(size_t) newLowCut->numSections] = previous[(size_t) numLowCutSections];
+
+    for( int s = 0; s < newHighCut->numSections; ++s )
+    {
+        sections[(size_t) (newLowCut->numSections + 1 + s)] = s < numHighCutSections
+                                                               ? previous[(size_t) (numLowCutSections + 1 + s)]
+                                                               : Section {};
+    }
+
+    lowCutPrototype = newLowCut;
+    highCutPrototype = newHighCut;
+    numLowCutSections = newLowCut->numSections;
+    numHighCutSections = newHighCut->numSections;
+    numSections = numLowCutSections + 1 + numHighCutSections;
+    needsDesign = true;
+}
+
+void OfflineChain::skipSmoothing()
+{
+    lowCutFreq.setCurrentAndTargetValue(lowCutFreq.getTargetValue());
+    highCutFreq.setCurrentAndTargetValue(highCutFreq.getTargetValue());
+    peakFreq.setCurrentAndTargetValue(peakFreq.getTargetValue());
+    peakGain.setCurrentAndTargetValue(peakGain.getTargetValue());
+    peakQuality.setCurrentAndTargetValue(peakQuality.getTargetValue());
+
+    needsDesign = true;
+}
+
+void OfflineChain::reset()
+{
+    for( auto& section : sections )
+        section.s1 = section.s2 = 0.0;
+}
+
+bool OfflineChain::isSmoothing() const
+{
+    return lowCutFreq.isSmoothing() || highCutFreq.isSmoothing() || peakFreq.isSmoothing()
+        || peakGain.isSmoothing() || peakQuality.isSmoothing();
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//the float chain keeps its sections at fixed slots, these are packed
+void OfflineChain::copyStateFrom(const ChainSections& chain, const ChainState& state)
+{
+    reset();
+
+    auto copy = [](const BiquadState& from, Section& to)
+    {
+        to.s1 = from.s1;
+        to.s2 = from.s2;
+    };
+
+    for( int s = 0; s < juce::jmin(numLowCutSections, chain.getNumLowCutSections()); ++s )
+        copy(state[s], sections[(size_t) s]);
+
+    copy(state[FilterKernels::peakSlot], sections[(size_t) numLowCutSections]);
+
+    for( int s = 0; s < juce::jmin(numHighCutSections, chain.getNumHighCutSections()); ++s )
+        copy(state[FilterKernels::highCutSlot + s], sections[(size_t) (numLowCutSections + 1 + s)]);
+}
+
+void OfflineChain::copyStateTo(const ChainSections& chain, ChainState& state) const
+{
+    state.reset();
+
+    auto copy = [](const Section& from, BiquadState& to)
+    {
+        to.s1 = (float) from.s1;
+        to.s2 = (float) from.s2;
+    };
+
+    for( int s = 0; s < juce::jmin(numLowCutSections, chain.getNumLowCutSections()); ++s )
+        copy(sections[(size_t) s], state[s]);
+
+    copy(sections[(size_t) numLowCutSections], state[FilterKernels::peakSlot]);
+
+    for( int s = 0; s < juce::jmin(numHighCutSections, chain.getNumHighCutSections()); ++s )
+        copy(sections[(size_t) (numLowCutSections + 1 + s)], state[FilterKernels::highCutSlot + s]);
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void OfflineChain::advance()
+{
+    if( isSmoothing() )
+    {
+        lowCutFreq.getNextValue();
+        highCutFreq.getNextValue();
+        peakFreq.getNextValue();
+        peakGain.getNextValue();
+        peakQuality.getNextValue();
+
+        needsDesign = true;
+    }
+
+    if( needsDesign )
+        design();
+}
+
+void OfflineChain::process(float* samples, int numSamples)
+{
+    for( int i = 0; i < numSamples; ++i )
+    {
+        advance();
+        samples[i] = (float) processSample(samples[i]);
+    }
+
+    snapToZero();
+}
+
+//the float chains flush their tails to zero, the double ones would take far longer to get there
+void OfflineChain::snapToZero()
+{
+    for( int s = 0; s < numSections; ++s )
+    {
+        juce::dsp::util::snapToZero(sections[(size_t) s].s1);
+        juce::dsp::util::snapToZero(sections[(size_t) s].s2);
+    }
+}
+
+void OfflineChain::design()
+{
+    needsDesign = false;
+
+    if( lowCutPrototype == nullptr || highCutPrototype == nullptr )
+        return;
+
+    auto setCoefficients = [](Section& section, const std::array<double, 6>& c)
+    {
+        section.b0 = c[0];
+        section.b1 = c[1];
+        section.b2 = c[2];
+        section.a1 = c[4];
+        section.a2 = c[5];
+    };
+
+    auto designCut = [&](const CutPrototype& prototype, double frequency, bool isHighPass, int first)
+    {
+        for( int s = 0; s < prototype.numSections; ++s )
+        {
+            setCoefficients(sections[(size_t) (first + s)],
+                            designCutSection(prototype.sections[(size_t) s], s == 0 ? prototype.gain : 1.0,
+                                             frequency, sampleRate, isHighPass));
+        }
+    };
+
+    designCut(*lowCutPrototype, lowCutFreq.getCurrentValue(), true, 0);
+    designCut(*highCutPrototype, highCutFreq.getCurrentValue(), false, numLowCutSections + 1);
+
+    //the same rbj bell the live chain gets from juce, worked out in double
+    auto omega = juce::MathConstants<double>::twoPi * juce::jmin(peakFreq.getCurrentValue(), 0.49 * sampleRate) / sampleRate;
+    auto alpha = std::sin(omega) / (2.0 * peakQuality.getCurrentValue());
+    auto A = std::pow(10.0, peakGain.getCurrentValue() / 40.0);
+    auto c2 = -2.0 * std::cos(omega);
+    auto a0 = 1.0 + alpha / A;
+
+    setCoefficients(sections[(size_t) numLowCutSections],
+                    { (1.0 + alpha * A) / a0, c2 / a0, (1.0 - alpha * A) / a0, 1.0, c2 / a0, (1.0 - alpha / A) / a0 });
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    OfflineChain.h
+    The chain the biquad engine runs while the host renders offline.
+
+    Same sections in the same order as a MonoChain, but designed and run in
+    double precision straight from the prototypes, with the frequencies, gain
+    and Q smoothed and the sections redesigned every sample while they move.
+    Nobody is waiting on a bounce, so it spends what the live chain saves.
+
+    The state is kept in the same transposed direct form as the float
+    sections, so switching tiers just copies it across: the filters carry on
+    from where the other tier left them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CutPrototype.h"
+
+struct ChainSettings;
+struct ChainSections;
+struct ChainState;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct OfflineChain
+{
+    void prepare(double sampleRate);
+
+    //glide to these from wherever the chain is, slope and family changes land at once
+    void setTargets(const ChainSettings& chainSettings);
+
+    //jump straight to the targets, leaves the state alone
+    void skipSmoothing();
+
+    void reset();
+    void snapToZero();
+
+    //the handover, sections either side that don't exist on the other start clear
+    void copyStateFrom(const ChainSections& chain, const ChainState& state);
+    void copyStateTo(const ChainSections& chain, ChainState& state) const;
+
+    void process(float* samples, int numSamples);
+
+    //for the mid/side loop, call advance() once before every sample
+    void advance();
+
+    inline double processSample(double x) noexcept
+    {
+        for( int s = 0; s < numSections; ++s )
+        {
+            auto& section = sections[(size_t) s];
+            auto y = section.b0 * x + section.s1;
+            section.s1 = section.b1 * x - section.a1 * y + section.s2;
+            section.s2 = section.b2 * x - section.a2 * y;
+            x = y;
+        }
+
+        return x;
+    }
+
+private:
+    struct Section
+    {
+        double b0 { 1.0 }, b1 { 0.0 }, b2 { 0.0 }, a1 { 0.0 }, a2 { 0.0 };
+        double s1 { 0.0 }, s2 { 0.0 };
+    };
+
+    //low cut sections, the bell, high cut sections, as in MonoChain
+    std::array<Section, 2 * maxCutSections + 1> sections;
+    int numSections { 1 };
+    int numLowCutSections { 0 }, numHighCutSections { 0 };
+
+    const CutPrototype* lowCutPrototype { nullptr };
+    const CutPrototype* highCutPrototype { nullptr };
+
+    juce::SmoothedValue<double, juce::ValueSmoothingTypes::Multiplicative> lowCutFreq { 20.0 }, highCutFreq { 20000.0 }, peakFreq { 750.0 };
+    juce::SmoothedValue<double> peakGain { 0.0 }, peakQuality { 1.0 };
+
+    double sampleRate { 44100.0 };
+    bool needsDesign { true };
+
+    bool isSmoothing() const;
+    void design();
+};
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    Parameters.cpp
+    The table every plugin parameter is made from.
+
+  ==============================================================================
+*/
+
+#include "Parameters.h"
+
+namespace Parameters
+{
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+juce::AudioProcessorValueTreeState::ParameterLayout createLayout(std::function<bool()> isSvfAvailable)
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+    for( auto& descriptor : descriptors )
+    {
+        if( descriptor.index == FilterEngineChoice && isSvfAvailable != nullptr )
+        {
+            juce::StringArray choices(descriptor.choices, descriptor.numChoices);
+
+            //the second choice is the svf, see filterEngineChoices
+            auto describe = [choices, isSvfAvailable] (int index, int)
+            {
+                return index == 1 && ! isSvfAvailable() ? juce::String("SVF (runs Biquad)") : choices[index];
+            };
+
+            layout.add(std::make_unique<juce::AudioParameterChoice>(descriptor.id, descriptor.id, choices, (int) descriptor.defaultValue,
+                                                                    juce::AudioParameterChoiceAttributes().withStringFromValueFunction(describe)));
+        }
+        else if( descriptor.choices != nullptr )
+        {
+            layout.add(std::make_unique<juce::AudioParameterChoice>(descriptor.id, descriptor.id,
+                                                                    juce::StringArray(descriptor.choices, descriptor.numChoices),
+                                                                    (int) descriptor.defaultValue));
+        }
+        else
+        {
+            layout.add(std::make_unique<juce::AudioParameterFloat>(descriptor.id, descriptor.id,
+                                                                   juce::NormalisableRange<float>(descriptor.minimum, descriptor.maximum,
+                                                                                                  descriptor.interval, descriptor.skew),
+                                                                   descriptor.defaultValue));
+        }
+    }
+
+    return layout;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+Values::Values(juce::AudioProcessorValueTreeState& apvts)
+{
+    for( auto& descriptor : descriptors )
+    {
+        values[(size_t) descriptor.index] = apvts.getRawParameterValue(descriptor.id);
+        jassert(values[(size_t) descriptor.index] != nullptr);
+    }
+}
+
+Snapshot Values::read() const noexcept
+{
+    Snapshot snapshot;
+
+    for( size_t i = 0; i < snapshot.size(); ++i )
+        snapshot[i] = values[i]->load(std::memory_order_relaxed);
+
+    return snapshot;
+}
+
+}
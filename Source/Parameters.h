@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    Parameters.h
+    The table every plugin parameter is made from.
+
+    The layout, the editor attachments, the midi map and the runners all take
+    their IDs from here. The atomics behind each one are looked up once, the
+    audio thread reads them by index.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+namespace Parameters
+{
+    enum Index
+    {
+        LowCutFreq,
+        HighCutFreq,
+        PeakFreq,
+        PeakGain,
+        PeakQuality,
+        LowCutSlope,
+        HighCutSlope,
+        LowCutFamily,
+        HighCutFamily,
+
+        //the second set ("R/S ") is the same again, offset by NumPerSet
+        NumPerSet,
+
+        StereoModeChoice = 2 * NumPerSet,
+        FilterEngineChoice,
+
+        NumParameters
+    };
+
+    //the index of a per chain parameter in set 0 (left / mid) or 1 (right / side)
+    constexpr Index inSet(Index index, int parameterSet)
+    {
+        return static_cast<Index>(index + parameterSet * NumPerSet);
+    }
+
+    struct Descriptor
+    {
+        Index index;
+        const char* id;
+        float minimum, maximum, interval, skew;
+        float defaultValue;
+
+        //only set for choice parameters, their range is the choice index
+        const char* const* choices;
+        int numChoices;
+    };
+
+    constexpr Descriptor floatParameter(Index index, const char* id, float minimum, float maximum,
+                                        float interval, float skew, float defaultValue)
+    {
+        return { index, id, minimum, maximum, interval, skew, defaultValue, nullptr, 0 };
+    }
+
+    template <size_t N>
+    constexpr Descriptor choiceParameter(Index index, const char* id, const char* const (&choices)[N], int defaultChoice)
+    {
+        return { index, id, 0.f, (float) N - 1.f, 1.f, 1.f, (float) defaultChoice, choices, (int) N };
+    }
+
+    //one per filter order, same order as the Slope enum
+    constexpr const char* slopeChoices[] =
+    {
+        "6 db/Oct", "12 db/Oct", "18 db/Oct", "24 db/Oct", "30 db/Oct", "36 db/Oct", "42 db/Oct", "48 db/Oct",
+        "54 db/Oct", "60 db/Oct", "66 db/Oct", "72 db/Oct", "78 db/Oct", "84 db/Oct", "90 db/Oct", "96 db/Oct"
+    };
+
+    constexpr const char* familyChoices[] = { "Butterworth", "Linkwitz-Riley", "Bessel", "Chebyshev" };
+    constexpr const char* stereoModeChoices[] = { "Stereo", "Mid/Side", "Dual Mono" };
+    constexpr const char* filterEngineChoices[] = { "Biquad", "SVF" };
+
+    constexpr Descriptor descriptors[] =
+    {
+        floatParameter(LowCutFreq, "LowCut Freq", 20.f, 20000.f, 1.f, 0.25f, 20.f),
+        floatParameter(HighCutFreq, "HighCut Freq", 20.f, 20000.f, 1.f, 0.25f, 20000.f),
+        floatParameter(PeakFreq, "Peak Freq", 20.f, 20000.f, 1.f, 0.25f, 750.f),
+        floatParameter(PeakGain, "Peak Gain", -24.f, 24.f, 0.5f, 1.f, 0.f),
+        floatParameter(PeakQuality, "Peak Quality", 0.1f, 10.f, 0.5f, 1.f, 1.f),
+        choiceParameter(LowCutSlope, "LowCut Slope", slopeChoices, 1),
+        choiceParameter(HighCutSlope, "HighCut Slope", slopeChoices, 1),
+        choiceParameter(LowCutFamily, "LowCut Family", familyChoices, 0),
+        choiceParameter(HighCutFamily, "HighCut Family", familyChoices, 0),
+
+        floatParameter(inSet(LowCutFreq, 1), "R/S LowCut Freq", 20.f, 20000.f, 1.f, 0.25f, 20.f),
+        floatParameter(inSet(HighCutFreq, 1), "R/S HighCut Freq", 20.f, 20000.f, 1.f, 0.25f, 20000.f),
+        floatParameter(inSet(PeakFreq, 1), "R/S Peak Freq", 20.f, 20000.f, 1.f, 0.25f, 750.f),
+        floatParameter(inSet(PeakGain, 1), "R/S Peak Gain", -24.f, 24.f, 0.5f, 1.f, 0.f),
+        floatParameter(inSet(PeakQuality, 1), "R/S Peak Quality", 0.1f, 10.f, 0.5f, 1.f, 1.f),
+        choiceParameter(inSet(LowCutSlope, 1), "R/S LowCut Slope", slopeChoices, 1),
+        choiceParameter(inSet(HighCutSlope, 1), "R/S HighCut Slope", slopeChoices, 1),
+        choiceParameter(inSet(LowCutFamily, 1), "R/S LowCut Family", familyChoices, 0),
+        choiceParameter(inSet(HighCutFamily, 1), "R/S HighCut Family", familyChoices, 0),
+
+        choiceParameter(StereoModeChoice, "Stereo Mode", stereoModeChoices, 0),
+        choiceParameter(FilterEngineChoice, "Filter Engine", filterEngineChoices, 0)
+    };
+
+    constexpr bool isInIndexOrder()
+    {
+        for( int i = 0; i < NumParameters; ++i )
+            if( descriptors[i].index != i )
+                return false;
+
+        return true;
+    }
+
+    static_assert(std::size(descriptors) == NumParameters, "every parameter needs a descriptor");
+    static_assert(isInIndexOrder(), "the descriptors have to be listed in Index order");
+
+    constexpr const char* getID(Index index) { return descriptors[index].id; }
+
+    //isSvfAvailable is asked whenever the engine choice is shown, so where the biquads
+    //stand in for the svf (it didn't pass the gate, or the bus is wider than stereo)
+    //the host shows that rather than the svf
+    juce::AudioProcessorValueTreeState::ParameterLayout createLayout(std::function<bool()> isSvfAvailable = {});
+
+    //the plain values of every parameter, read in one go
+    using Snapshot = std::array<float, NumParameters>;
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    //the apvts atomics, found once when the processor is built
+    struct Values
+    {
+        explicit Values(juce::AudioProcessorValueTreeState& apvts);
+
+        float get(Index index) const noexcept { return values[(size_t) index]->load(std::memory_order_relaxed); }
+
+        Snapshot read() const noexcept;
+
+    private:
+        std::array<std::atomic<float>*, NumParameters> values;
+    };
+}
@@ -23,12 +23,9 @@ void LookAndFeel::drawRotarySlider(juce::Graphics & g,
     
     
     auto bounds = Rectangle<float>(x, y, width, height);
-    //knob background
-    g.setColour(Colour(211u, 0u, 255u));
-    g.fillEllipse(bounds);
-    //this is the border on the knobs
-    g.setColour(Colour(0u, 198u, 255u));
-    g.drawEllipse(bounds, 1.f);
+    //knob background and border, from the shared image cache
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    g.drawImage(getKnobImage(jmin(width, height), scale), bounds);
     
     //Text for the knobs
     if( auto* rswl = dynamic_cast<RotarySliderWithLabels*>(&slider))
@@ -55,7 +52,7 @@ void LookAndFeel::drawRotarySlider(juce::Graphics & g,
         
         g.fillPath(p);
         
-        g.setFont(rswl->getTextHeight());
+        g.setFont(labelFont);
         //get text
         auto text = rswl->getDisplayString();
         auto strWidth = g.getCurrentFont().getStringWidth(text);
@@ -80,6 +77,70 @@ void LookAndFeel::drawRotarySlider(juce::Graphics & g,
     
 
     
+}
+
+const juce::Image& LookAndFeel::getKnobImage(int diameter, float scale)
+{
+    using namespace juce;
+    
+    //same key for the same pixels, hi-dpi displays get their own entry
+    auto pixels = jmax(1, roundToInt(diameter * scale));
+    auto& image = knobImages.get(pixels);
+    
+    if( image.isNull() )
+    {
+        image = Image(Image::ARGB, pixels, pixels, true);
+        Graphics g(image);
+        auto bounds = Rectangle<float>(0.f, 0.f, (float) pixels, (float) pixels).reduced(0.5f * scale);
+        //knob background
+        g.setColour(Colour(211u, 0u, 255u));
+        g.fillEllipse(bounds);
+        //this is the border on the knobs
+        g.setColour(Colour(0u, 198u, 255u));
+        g.drawEllipse(bounds, scale);
+    }
+    
+    return image;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void SharedRepaintTimer::addClient(Client* client)
+{
+    clients.addIfNotAlreadyThere(client);
+    
+    if( ! isTimerRunning() )
+        startTimerHz(60);
+}
+
+void SharedRepaintTimer::removeClient(Client* client)
+{
+    clients.removeFirstMatchingValue(client);
+    
+    if( clients.isEmpty() )
+        stopTimer();
+}
+
+void SharedRepaintTimer::timerCallback()
+{
+    Trace::Scope traceScope { "SharedRepaintTimer::timerCallback" };
+    
+    //backwards so a client can remove itself from its callback
+    for( int i = clients.size(); --i >= 0; )
+        clients.getUnchecked(i)->timerCallback();
+}
+
+const std::vector<double>& FrequencyGrid::getFrequencies(int width)
+{
+    auto& frequencies = grids.get(width);
+    
+    if( frequencies.size() != (size_t) width )
+    {
+        frequencies.resize((size_t) width);
+        
+        for( int i = 0; i < width; ++i )
+            frequencies[(size_t) i] = juce::mapToLog10(double(i) / double(width), 20.0, 20000.0);
+    }
+    
+    return frequencies;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
@@ -116,7 +177,7 @@ void RotarySliderWithLabels::paint(juce::Graphics &g)
     auto radius = sliderBounds.getWidth() * 0.5;
     
     g.setColour(Colour(0u, 172u, 1u));
-    g.setFont(getTextHeight());
+    g.setFont(lnf->getLabelFont());
     
     auto numChoices = labels.size();
     for( int i = 0; i < numChoices; ++i )
@@ -198,114 +259,84 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 //==============================================================================
 ResponseCurveComponent::ResponseCurveComponent(SimpleEqAudioProcessor& p) : audioProcessor(p)
 {
-    //grab all parameters and listen to them
-    const auto& params = audioProcessor.getParameters();
-    for( auto param : params )
-    {
-        param->addListener(this);
-    }
-    updateChain();
-
-    startTimerHz(60);
+    //the snapshot and the curve come on the first tick, the first frame doesn't wait for them
+    repaintTimer->addClient(this);
 }
 
 ResponseCurveComponent::~ResponseCurveComponent()
 {
-    const auto& params = audioProcessor.getParameters();
-    for( auto param : params )
-    {
-        param->removeListener(this);
-    }
-}
-
-void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue)
-{
-    //set Atomic flag
-    parametersChanged.set(true);
+    repaintTimer->removeClient(this);
 }
 
 void ResponseCurveComponent::timerCallback()
 {
-    if( parametersChanged.compareAndSetBool(false, true) )
+    Trace::Scope traceScope { "ResponseCurveComponent::timerCallback" };
+    
+    //the processor bumps the version whenever what it runs changes,
+    //a fresh editor starts at version 0 so it keeps the curve after close and reload
+    if( audioProcessor.getSnapshotIfNewer(snapshot) || isCurveStale )
     {
-        updateChain();
-        //signal a repaint
+        updateResponseCurve();
         repaint();
     }
 }
 
-void ResponseCurveComponent::updateChain()
+void ResponseCurveComponent::resized()
 {
-    //update the monochain
-    auto chainSettings = getChainSettings(audioProcessor.apvts);
-    auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
-    
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+    //the old curve is drawn until the next tick has the new width
+    isCurveStale = true;
 }
-void ResponseCurveComponent::paint (juce::Graphics& g)
+
+void ResponseCurveComponent::updateResponseCurve()
 {
-//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    Trace::Scope traceScope { "ResponseCurveComponent::updateResponseCurve" };
+    
     using namespace juce;
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll (Colours::black);
-    auto responseArea = getLocalBounds();
+    isCurveStale = false;
     
+    auto responseArea = getLocalBounds();
     auto w = responseArea.getWidth();
     
-    //get chain elements
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highcut = monoChain.get<ChainPositions::HighCut>();
+    responseCurve.clear();
     
-    //get sample rate
-    auto sampleRate = audioProcessor.getSampleRate();
+    if( w <= 0 )
+        return;
+    
+    //first chain (left / mid), with the sample rate it was designed at.
+    //whichever engine runs, nothing is designed here
+    auto sampleRate = snapshot.sampleRate;
+    const auto& chain = snapshot.chains[0];
     
     //place to store them^^
     std::vector<double> mags;
     
     mags.resize(w);
     
+    //normalized to human hearing range, shared by all the editors
+    const auto& freqs = frequencyGrid->getFrequencies(w);
+    
     for( int i = 0; i < w; ++i )
     {
         double mag = 1.f;
-        //normalize to human hearing range
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
-        
-        //check if the filters are bypassed
-        if(! monoChain.isBypassed<ChainPositions::Peak>() )
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        auto freq = freqs[(size_t) i];
         
-        //low and high have 4ea
-        if( !lowcut.isBypassed<0>() )
-            mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if( !lowcut.isBypassed<1>() )
-            mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if( !lowcut.isBypassed<2>() )
-            mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if( !lowcut.isBypassed<3>() )
-            mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        
-        if( !highcut.isBypassed<0>() )
-            mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if( !highcut.isBypassed<1>() )
-            mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if( !highcut.isBypassed<2>() )
-            mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if( !highcut.isBypassed<3>() )
-            mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        //nothing published yet (not prepared), draw it flat
+        if( sampleRate > 0 )
+        {
+            //low cut, peak and high cut, only the sections the slopes switched on
+            for( int s = 0; s < chain.lowCut.numSections; ++s )
+                mag *= getMagnitudeForFrequency(chain.lowCut[s], freq, sampleRate);
+            
+            mag *= getMagnitudeForFrequency(chain.peak, freq, sampleRate);
+            
+            for( int s = 0; s < chain.highCut.numSections; ++s )
+                mag *= getMagnitudeForFrequency(chain.highCut[s], freq, sampleRate);
+        }
 
         //convert mags to decibels and store it
         mags[i] = Decibels::gainToDecibels(mag);
     }
     
-    //paths for the response curve
-    Path responseCurve;
-    
     const double outputMin = responseArea.getBottom();
     const double outputMax = responseArea.getY();
     auto map = [outputMin, outputMax](double input)
@@ -320,11 +351,22 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
     {
         responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
     }
+}
+
+void ResponseCurveComponent::paint (juce::Graphics& g)
+{
+    Trace::Scope traceScope { "ResponseCurveComponent::paint" };
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    using namespace juce;
+    // (Our component is opaque, so we must completely fill the background with a solid colour)
+    g.fillAll (Colours::black);
+    auto responseArea = getLocalBounds();
     
     //drawing the window
     g.setColour(Colours::orange);
     g.drawRoundedRectangle(responseArea.toFloat(), 4.f, 1.f);
     
+    //nothing until the first tick has built it
     g.setColour(Colours::white);
     g.strokePath(responseCurve, PathStrokeType(2.f));
     
@@ -336,23 +378,15 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
 //Initilaizers
 SimpleEqAudioProcessorEditor::SimpleEqAudioProcessorEditor (SimpleEqAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p),
-peakFreqSlider(*audioProcessor.apvts.getParameter("Peak Freq"), "Hz"),
-peakGainSlider(*audioProcessor.apvts.getParameter("Peak Gain"), "dB"),
-peakQualitySlider(*audioProcessor.apvts.getParameter("Peak Quality"), ""),
-lowCutFreqSlider(*audioProcessor.apvts.getParameter("LowCut Freq"), "Hz"),
-highCutFreqSlider(*audioProcessor.apvts.getParameter("HighCut Freq"), "Hz"),
-lowCutSlopeSlider(*audioProcessor.apvts.getParameter("LowCut Slope"), "dB/Oct"),
-highCutSlopeSlider(*audioProcessor.apvts.getParameter("HighCut Slope"), "dB/Oct"),
+peakFreqSlider(*audioProcessor.apvts.getParameter(Parameters::getID(Parameters::PeakFreq)), "Hz"),
+peakGainSlider(*audioProcessor.apvts.getParameter(Parameters::getID(Parameters::PeakGain)), "dB"),
+peakQualitySlider(*audioProcessor.apvts.getParameter(Parameters::getID(Parameters::PeakQuality)), ""),
+lowCutFreqSlider(*audioProcessor.apvts.getParameter(Parameters::getID(Parameters::LowCutFreq)), "Hz"),
+highCutFreqSlider(*audioProcessor.apvts.getParameter(Parameters::getID(Parameters::HighCutFreq)), "Hz"),
+lowCutSlopeSlider(*audioProcessor.apvts.getParameter(Parameters::getID(Parameters::LowCutSlope)), "dB/Oct"),
+highCutSlopeSlider(*audioProcessor.apvts.getParameter(Parameters::getID(Parameters::HighCutSlope)), "dB/Oct"),
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-//attaching GUI sliders to the filters
-responseCurveComponent(audioProcessor),
-peakFreqSliderAttachment(audioProcessor.apvts, "Peak Freq", peakFreqSlider),
-peakGainSliderAttachment(audioProcessor.apvts, "Peak Gain", peakGainSlider),
-peakQualitySliderAttachment(audioProcessor.apvts, "Peak Quality", peakQualitySlider),
-lowCutFreqSliderAttachment(audioProcessor.apvts, "LowCut Freq", lowCutFreqSlider),
-highCutFreqSliderAttachment(audioProcessor.apvts, "HighCut Freq", highCutFreqSlider),
-lowCutSlopeSliderAttachment(audioProcessor.apvts, "LowCut Slope", lowCutSlopeSlider),
-highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlopeSlider)
+responseCurveComponent(audioProcessor)
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 {
     // Make sure that before the constructor has finished, you've set the
@@ -373,11 +407,11 @@ highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlope
     highCutFreqSlider.labels.add({0.f, "20Hz"});
     highCutFreqSlider.labels.add({1.f, "20kHz"});
     
-    lowCutSlopeSlider.labels.add({0.f, "12"});
-    lowCutSlopeSlider.labels.add({1.f, "48"});
+    lowCutSlopeSlider.labels.add({0.f, "6"});
+    lowCutSlopeSlider.labels.add({1.f, "96"});
     
-    highCutSlopeSlider.labels.add({0.f, "12"});
-    highCutSlopeSlider.labels.add({1.f, "48"});
+    highCutSlopeSlider.labels.add({0.f, "6"});
+    highCutSlopeSlider.labels.add({1.f, "96"});
     
     
     for( auto* comp : getComps() )
@@ -387,12 +421,43 @@ highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlope
     
     
     setSize (600, 480);
+    
+    //the sliders get attached on the first tick, once the editor is up
+    repaintTimer->addClient(this);
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 }
 
 SimpleEqAudioProcessorEditor::~SimpleEqAudioProcessorEditor()
 {
+    repaintTimer->removeClient(this);
+}
 
+void SimpleEqAudioProcessorEditor::timerCallback()
+{
+    attachSliders();
+    repaintTimer->removeClient(this);
+}
+
+//attaching GUI sliders to the filters
+void SimpleEqAudioProcessorEditor::attachSliders()
+{
+    Trace::Scope traceScope { "SimpleEqAudioProcessorEditor::attachSliders" };
+    
+    if( ! attachments.empty() )
+        return;
+    
+    auto attach = [this](Parameters::Index parameter, juce::Slider& slider)
+    {
+        attachments.push_back(std::make_unique<Attachment>(audioProcessor.apvts, Parameters::getID(parameter), slider));
+    };
+    
+    attach(Parameters::PeakFreq, peakFreqSlider);
+    attach(Parameters::PeakGain, peakGainSlider);
+    attach(Parameters::PeakQuality, peakQualitySlider);
+    attach(Parameters::LowCutFreq, lowCutFreqSlider);
+    attach(Parameters::HighCutFreq, highCutFreqSlider);
+    attach(Parameters::LowCutSlope, lowCutSlopeSlider);
+    attach(Parameters::HighCutSlope, highCutSlopeSlider);
 }
 
 //==============================================================================
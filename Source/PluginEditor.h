@@ -12,6 +12,44 @@
 #include "PluginProcessor.h"
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  process-wide GUI resources, every open editor shares one of each
+//  through juce::SharedResourcePointer and they go away with the last editor
+
+//a few entries keyed by size, the one used longest ago goes when it's full.
+//windows being resized would otherwise leave one behind for every size they went through
+template <typename Value, size_t maxEntries>
+struct SizeCache
+{
+    //a default constructed Value the first time, the reference holds until the next call
+    Value& get(int size)
+    {
+        auto entry = entries.find(size);
+        
+        if( entry == entries.end() )
+        {
+            if( entries.size() >= maxEntries )
+            {
+                entries.erase(std::min_element(entries.begin(), entries.end(), [](const auto& a, const auto& b)
+                                               { return a.second.lastUsed < b.second.lastUsed; }));
+            }
+            
+            entry = entries.emplace(size, Entry {}).first;
+        }
+        
+        entry->second.lastUsed = ++useCount;
+        return entry->second.value;
+    }
+    
+private:
+    struct Entry
+    {
+        Value value;
+        juce::uint32 lastUsed { 0 };
+    };
+    
+    std::map<int, Entry> entries;
+    juce::uint32 useCount { 0 };
+};
 
 struct LookAndFeel : juce::LookAndFeel_V4
 {
@@ -21,6 +59,43 @@ struct LookAndFeel : juce::LookAndFeel_V4
                            float rotaryStartAngle,
                            float rotaryEndAngle,
                            juce::Slider&) override;
+    
+    const juce::Font& getLabelFont() const { return labelFont; }
+    
+private:
+    //knob body rendered once per size, all the knobs of all the editors reuse it
+    const juce::Image& getKnobImage(int diameter, float scale);
+    
+    //a couple of knob sizes per editor, times the display scales it has been on
+    SizeCache<juce::Image, 16> knobImages;
+    juce::Font labelFont { 14.f };
+};
+
+//one 60Hz timer for all the editors instead of one per response curve
+struct SharedRepaintTimer : juce::Timer
+{
+    struct Client
+    {
+        virtual ~Client() = default;
+        virtual void timerCallback() = 0;
+    };
+    
+    void addClient(Client* client);
+    void removeClient(Client* client);
+    
+    void timerCallback() override;
+    
+private:
+    juce::Array<Client*> clients;
+};
+
+//log spaced 20Hz - 20kHz frequency for every pixel column, computed once per width
+struct FrequencyGrid
+{
+    const std::vector<double>& getFrequencies(int width);
+    
+private:
+    SizeCache<std::vector<double>, 8> grids;
 };
 
 struct RotarySliderWithLabels : juce::Slider
@@ -31,7 +106,12 @@ struct RotarySliderWithLabels : juce::Slider
                     param(&rap),
                     suffix(unitSuffix)
     {
-        setLookAndFeel(&lnf);
+        setLookAndFeel(lnf.get());
+        
+        //the attachment only arrives after the first frame, show the parameter's range and value until then
+        auto range = rap.getNormalisableRange();
+        setNormalisableRange({ (double) range.start, (double) range.end, (double) range.interval, (double) range.skew });
+        setValue(rap.convertFrom0to1(rap.getValue()), juce::dontSendNotification);
     }
     //reset look and feel
     ~RotarySliderWithLabels()
@@ -54,42 +134,49 @@ struct RotarySliderWithLabels : juce::Slider
     juce::String getDisplayString() const;
     
 private:
-    LookAndFeel lnf;
+    juce::SharedResourcePointer<LookAndFeel> lnf;
     
     juce::RangedAudioParameter* param;
     juce::String suffix;
 };
 
 struct ResponseCurveComponent: juce::Component,
-juce::AudioProcessorParameter::Listener,
-//Atomic Flag to update the GUI
-juce::Timer
+//polls the processor's coefficient snapshot
+SharedRepaintTimer::Client
 {
     ResponseCurveComponent(SimpleEqAudioProcessor&);
     ~ResponseCurveComponent();
-    void parameterValueChanged (int parameterIndex, float newValue) override;
-
-    void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override { }
     
     void timerCallback() override;
     
     void paint(juce::Graphics& g) override;
+    void resized() override;
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     SimpleEqAudioProcessor& audioProcessor;
-    juce::Atomic<bool> parametersChanged { false };
     
-    MonoChain monoChain;
-//keep the response curve after close and reload
-    void updateChain();
+    juce::SharedResourcePointer<SharedRepaintTimer> repaintTimer;
+    juce::SharedResourcePointer<FrequencyGrid> frequencyGrid;
+    
+    //the designs the audio thread is running, only copied when their version moves
+    CoefficientSnapshot snapshot;
+    
+    //built on the timer when the snapshot or the width changes, paint only strokes it.
+    //empty until the first tick, so the first frame is just the frame
+    juce::Path responseCurve;
+    bool isCurveStale { true };
+    
+    void updateResponseCurve();
 };
 //~~~~^^~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 //==============================================================================
 /**
 */
-class SimpleEqAudioProcessorEditor  : public juce::AudioProcessorEditor
+class SimpleEqAudioProcessorEditor  : public juce::AudioProcessorEditor,
+//attaches the sliders on the first tick after opening
+SharedRepaintTimer::Client
 
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -102,6 +189,8 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
     
+    void timerCallback() override;
+    
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
@@ -122,13 +211,12 @@ private:
     using APVTS = juce::AudioProcessorValueTreeState;
     using Attachment = APVTS::SliderAttachment;
     
-    Attachment peakFreqSliderAttachment,
-        peakGainSliderAttachment,
-        peakQualitySliderAttachment,
-        lowCutFreqSliderAttachment,
-        highCutFreqSliderAttachment,
-        lowCutSlopeSliderAttachment,
-        highCutSlopeSliderAttachment;
+    //made after the editor is on screen, not in the constructor: each one adds a
+    //parameter listener and pushes the value through its slider
+    std::vector<std::unique_ptr<Attachment>> attachments;
+    juce::SharedResourcePointer<SharedRepaintTimer> repaintTimer;
+    
+    void attachSliders();
     
     std::vector<juce::Component*> getComps();
     
@@ -8,6 +8,8 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "CoefficientCache.h"
+#include "AccuracyGate.h"
 
 //==============================================================================
 SimpleEqAudioProcessor::SimpleEqAudioProcessor()
@@ -22,6 +24,10 @@ SimpleEqAudioProcessor::SimpleEqAudioProcessor()
                        )
 #endif
 {
+    apvts.state.setProperty("stateVersion", stateVersion, nullptr);
+
+    isSvfAvailable = AccuracyGate::isEnabled(AccuracyGate::SvfPath);
+    setStereoMode(StereoMode::Linked);
 }
 
 SimpleEqAudioProcessor::~SimpleEqAudioProcessor()
@@ -63,7 +69,18 @@ bool SimpleEqAudioProcessor::isMidiEffect() const
 
 double SimpleEqAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailSeconds.load();
+}
+
+double SimpleEqAudioProcessor::getSkippedBlockFraction() const
+{
+    auto blocks = numBlocks.load();
+    return blocks > 0 ? (double) numSkippedBlocks.load() / (double) blocks : 0.0;
+}
+
+ChannelWorkers::Stats SimpleEqAudioProcessor::getChannelWorkerStats() const
+{
+    return channelWorkers != nullptr ? channelWorkers->getStats() : ChannelWorkers::Stats {};
 }
 
 int SimpleEqAudioProcessor::getNumPrograms()
@@ -105,10 +122,54 @@ void SimpleEqAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     
     spec.sampleRate = sampleRate;
     
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    //the only allocation the filters make, everything after this works in place
+    chains.allocate(juce::jmax(minChains, getTotalNumOutputChannels()));
+    offlineChains.resize((size_t) chains.size());
+    
+    //whatever this cpu runs fastest of the kernels that passed, unless SIMPLEEQ_KERNEL says otherwise
+    kernelVariant = FilterKernels::getSelectedVariant(AccuracyGate::isKernelEnabled);
+    
+    for( int c = 0; c < chains.size(); ++c )
+        chains[c].prepare(spec);
+    
+    chains.setKernel(kernelVariant);
+    
+    for( auto& offlineChain : offlineChains )
+        offlineChain.prepare(sampleRate);
+    
+    //the old workers were sized for the old block, and the bus may have changed under them
+    channelWorkers.reset();
+    
+    if( numChannelWorkers > 0 && getTotalNumOutputChannels() >= ChannelWorkers::minChannels )
+        channelWorkers = std::make_unique<ChannelWorkers>(numChannelWorkers, sampleRate, samplesPerBlock);
     
+    leftSvf.prepare(sampleRate);
+    rightSvf.prepare(sampleRate);
+    midiCCMap.prepare(sampleRate);
+    
+    //what GraphRunner --verify recorded, nothing is measured here
+    useBatchDesigner = AccuracyGate::isEnabled(AccuracyGate::BatchDesignedPath);
+    useFusedMidSide = AccuracyGate::isEnabled(AccuracyGate::FusedMidSidePath);
+    
+    //the svf only up to two channels, there's only the one pair of svf chains.
+    //the engine parameter's text changes with it, the host is told to ask again
+    auto svfAvailable = AccuracyGate::isEnabled(AccuracyGate::SvfPath) && getTotalNumOutputChannels() <= 2;
+    
+    if( isSvfAvailable.exchange(svfAvailable) != svfAvailable )
+        updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withParameterInfoChanged(true));
+    
+    if( prewarmCoefficients )
+        coefficientCache->prewarm(getChainSettings(parameterValues.read()), sampleRate);
+
     updateFilters();
+    publishSnapshot();
+    
+    //start from the current settings rather than gliding in from the defaults
+    leftSvf.reset();
+    rightSvf.reset();
+    
+    for( auto& offlineChain : offlineChains )
+        offlineChain.skipSmoothing();
 
 //~~^^~~~~~~~~~~~~~~~~~~~~~~~~~~~
     
@@ -118,6 +179,8 @@ void SimpleEqAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    channelWorkers.reset();
+    midiCCMap.endGestures();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -128,11 +191,11 @@ bool SimpleEqAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     return true;
   #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every channel gets its own chain, so anything from mono up to
+    // maxChannels works (ambisonics, object beds, discrete buses).
+    auto numChannels = layouts.getMainOutputChannelSet().size();
+
+    if (numChannels < 1 || numChannels > maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -148,6 +211,7 @@ bool SimpleEqAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 
 void SimpleEqAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    Trace::Scope traceScope { "processBlock" };
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -161,22 +225,498 @@ void SimpleEqAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    //kept up to date through silence too, the tail length and the editor's curve follow the settings
     updateFilters();
     
+    if( skipSilentBlock(buffer, midiMessages) )
+    {
+        //no cc in a skipped block, but a gesture can still run out
+        midiCCMap.publishChanges(buffer.getNumSamples());
+        publishSnapshot();
+        return;
+    }
+    
 //  audio flow dsp
     juce::dsp::AudioBlock<float> block(buffer);
+    auto numSamples = buffer.getNumSamples();
+
+    //split the block at every mapped cc so the change lands on its sample,
+    //only the band the controller belongs to gets redesigned between segments
+    auto parameters = parameterValues.read();
+    std::array<ChainSettings, 2> chainSettings { getChainSettings(parameters, 0), getChainSettings(parameters, 1) };
+    int segmentStart = 0;
+    int dirtyBands = 0;
+
+    for( const auto metadata : midiMessages )
+    {
+        auto position = juce::jlimit(0, numSamples, metadata.samplePosition);
+
+        if( position - segmentStart >= midiSegmentGranularity )
+        {
+            applyBandChanges(dirtyBands, chainSettings);
+            dirtyBands = 0;
+
+            processSegment(block.getSubBlock((size_t) segmentStart, (size_t) (position - segmentStart)));
+            segmentStart = position;
+        }
+
+        dirtyBands |= midiCCMap.apply(metadata.getMessage(), chainSettings);
+    }
+
+    applyBandChanges(dirtyBands, chainSettings);
+    processSegment(block.getSubBlock((size_t) segmentStart, (size_t) (numSamples - segmentStart)));
+
+    midiCCMap.publishChanges(numSamples);
     
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    //after the cc segments, so the editor sees what the block ended on
+    publishSnapshot();
     
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    //only worth measuring what's left in the filters once the input has gone quiet
+    lastOutputLevel = silentSamples > 0 ? buffer.getMagnitude(0, numSamples) : 1.f;
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 }
 
+static bool isSameCut(const CutCoefficients& a, const CutCoefficients& b)
+{
+    //unused sections are always zeroed, the whole arrays can be compared
+    return a.numSections == b.numSections && a.sections == b.sections;
+}
+
+static bool isSameChain(const ChainCoefficients& a, const ChainCoefficients& b)
+{
+    return isSameCut(a.lowCut, b.lowCut) && a.peak == b.peak && isSameCut(a.highCut, b.highCut);
+}
+
+static bool isSameSettings(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.peakFreq == b.peakFreq && a.peakGainInDecibels == b.peakGainInDecibels && a.peakQuality == b.peakQuality
+        && a.lowCutFreq == b.lowCutFreq && a.highCutFreq == b.highCutFreq
+        && a.lowCutSlope == b.lowCutSlope && a.highCutSlope == b.highCutSlope
+        && a.lowCutFamily == b.lowCutFamily && a.highCutFamily == b.highCutFamily;
+}
+
+void SimpleEqAudioProcessor::publishSnapshot()
+{
+    CoefficientSnapshot next;
+    next.stereoMode = stereoMode;
+    next.sampleRate = getSampleRate();
+    next.engine = filterEngine;
+
+    if( filterEngine == FilterEngine::SvfEngine )
+    {
+        next.settings = svfSettings;
+        
+        //the svf responses are the bilinear ones the biquads are designed for, so the editor gets
+        //those biquads. only looked up (or designed) again when the svf settings have moved
+        if( snapshot.engine == FilterEngine::SvfEngine && snapshot.sampleRate == next.sampleRate
+            && isSameSettings(next.settings[0], snapshot.settings[0]) && isSameSettings(next.settings[1], snapshot.settings[1]) )
+        {
+            next.chains = snapshot.chains;
+        }
+        else if( next.sampleRate > 0 )
+        {
+            auto numChains = stereoMode == StereoMode::Linked ? 1 : 2;
+            designChains(svfSettings.data(), next.chains.data(), numChains);
+            
+            if( numChains == 1 )
+                next.chains[1] = next.chains[0];
+        }
+    }
+    else
+        next.chains = { getChainCoefficients(chains.getSections(0)), getChainCoefficients(chains.getSections(1)) };
+
+    //nothing moved, the editor has nothing to redraw
+    if( isSameChain(next.chains[0], snapshot.chains[0]) && isSameChain(next.chains[1], snapshot.chains[1])
+        && isSameSettings(next.settings[0], snapshot.settings[0]) && isSameSettings(next.settings[1], snapshot.settings[1])
+        && next.stereoMode == snapshot.stereoMode && next.sampleRate == snapshot.sampleRate && next.engine == snapshot.engine )
+        return;
+
+    auto sequence = snapshotSequence.load(std::memory_order_relaxed);
+    snapshotSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    next.version = (sequence + 2) / 2;
+    snapshot = next;
+
+    snapshotSequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool SimpleEqAudioProcessor::getSnapshotIfNewer(CoefficientSnapshot& result) const
+{
+    auto before = snapshotSequence.load(std::memory_order_acquire);
+
+    if( (before & 1) != 0 || before / 2 == result.version )
+        return false;
+
+    auto copy = snapshot;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    //rewritten while we were copying it
+    if( snapshotSequence.load(std::memory_order_relaxed) != before )
+        return false;
+
+    result = copy;
+    return true;
+}
+
+bool SimpleEqAudioProcessor::skipSilentBlock(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midiMessages)
+{
+    auto numSamples = buffer.getNumSamples();
+    auto threshold = juce::Decibels::decibelsToGain(silenceThresholdDb);
+    
+    numBlocks.fetch_add(1, std::memory_order_relaxed);
+    
+    if( buffer.getMagnitude(0, numSamples) > threshold )
+    {
+        silentSamples = 0;
+        isIdle = false;
+        return false;
+    }
+    
+    silentSamples += numSamples;
+    
+    //the tail has to have run out before this block started, and the state has to agree
+    if( ! midiMessages.isEmpty() || (double) (silentSamples - numSamples) <= tailSamples || lastOutputLevel > threshold )
+    {
+        isIdle = false;
+        return false;
+    }
+    
+    //going idle: drop whatever is left in the state once, then just hand back silence
+    if( ! isIdle )
+    {
+        resetChains();
+        leftSvf.reset();
+        rightSvf.reset();
+        isIdle = true;
+    }
+    
+    buffer.clear();
+    numSkippedBlocks.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void SimpleEqAudioProcessor::processSegment(juce::dsp::AudioBlock<float> block)
+{
+    if( block.getNumSamples() == 0 )
+        return;
+
+    if( filterEngine == FilterEngine::SvfEngine )
+    {
+        processSvf(block);
+        return;
+    }
+    
+    if( isOfflineTier )
+    {
+        processOffline(block);
+        return;
+    }
+    
+    if( stereoMode == StereoMode::MidSide )
+    {
+        processMidSide(block);
+        return;
+    }
+
+    //a wide bus is spread over the workers, unless they've been falling behind
+    if( channelWorkers != nullptr && channelWorkers->process(chains, block) )
+        return;
+    
+    chains.process(block, 0, juce::jmin((int) block.getNumChannels(), chains.size()));
+}
+
+void SimpleEqAudioProcessor::processMidSide(juce::dsp::AudioBlock<float>& block)
+{
+    auto* left = block.getChannelPointer(0);
+    auto* right = block.getChannelPointer(1);
+    auto numSamples = (int) block.getNumSamples();
+
+    if( useFusedMidSide )
+        processMidSideFused(chains[0], chains[1], left, right, numSamples);
+    else
+        processMidSideSeparately(chains[0], chains[1], left, right, numSamples);
+}
+
+void processMidSideSeparately(MonoChain& midChain, MonoChain& sideChain, float* left, float* right, int numSamples)
+{
+    for( int i = 0; i < numSamples; ++i )
+    {
+        auto mid = (left[i] + right[i]) * 0.5f;
+        right[i] = (left[i] - right[i]) * 0.5f;
+        left[i] = mid;
+    }
+
+    //both chains side by side, as a pair of lanes
+    FilterKernels::Lane lanes[] = { midChain.makeLane(left), sideChain.makeLane(right) };
+    midChain.kernel(lanes, 2, numSamples);
+    midChain.state.snapToZero();
+    sideChain.state.snapToZero();
+
+    for( int i = 0; i < numSamples; ++i )
+    {
+        auto mid = left[i];
+        left[i] = mid + right[i];
+        right[i] = mid - right[i];
+    }
+}
+
+//m/s encode and decode happen a chunk at a time around the kernel instead of as extra passes
+//over the buffer, the chunk is still in l1 for all three. both chains run as a pair of lanes
+//with the same arithmetic as the separate passes, so the output is the same to the bit
+void processMidSideFused(MonoChain& midChain, MonoChain& sideChain, float* left, float* right, int numSamples)
+{
+    constexpr int chunkSize = 256;
+    alignas(64) std::array<float, chunkSize> mid, side;
+
+    FilterKernels::Lane lanes[] = { midChain.makeLane(mid.data()), sideChain.makeLane(side.data()) };
+
+    for( int start = 0; start < numSamples; start += chunkSize )
+    {
+        auto numInChunk = juce::jmin(chunkSize, numSamples - start);
+        auto* l = left + start;
+        auto* r = right + start;
+
+        for( int i = 0; i < numInChunk; ++i )
+        {
+            mid[(size_t) i] = (l[i] + r[i]) * 0.5f;
+            side[(size_t) i] = (l[i] - r[i]) * 0.5f;
+        }
+
+        midChain.kernel(lanes, 2, numInChunk);
+
+        for( int i = 0; i < numInChunk; ++i )
+        {
+            l[i] = mid[(size_t) i] + side[(size_t) i];
+            r[i] = mid[(size_t) i] - side[(size_t) i];
+        }
+    }
+
+    midChain.state.snapToZero();
+    sideChain.state.snapToZero();
+}
+
+void SimpleEqAudioProcessor::processOffline(juce::dsp::AudioBlock<float>& block)
+{
+    auto numSamples = (int) block.getNumSamples();
+    
+    if( stereoMode == StereoMode::MidSide )
+    {
+        auto* left = block.getChannelPointer(0);
+        auto* right = block.getChannelPointer(1);
+        auto& midChain = offlineChains[0];
+        auto& sideChain = offlineChains[1];
+        
+        for( int i = 0; i < numSamples; ++i )
+        {
+            midChain.advance();
+            sideChain.advance();
+            
+            auto mid = midChain.processSample(((double) left[i] + right[i]) * 0.5);
+            auto side = sideChain.processSample(((double) left[i] - right[i]) * 0.5);
+            
+            left[i] = (float) (mid + side);
+            right[i] = (float) (mid - side);
+        }
+        
+        midChain.snapToZero();
+        sideChain.snapToZero();
+        return;
+    }
+    
+    auto numChannels = juce::jmin((int) block.getNumChannels(), (int) offlineChains.size());
+    
+    for( int c = 0; c < numChannels; ++c )
+        offlineChains[(size_t) c].process(block.getChannelPointer((size_t) c), numSamples);
+}
+
+//the float and double chains keep their state in the same form, the one taking over carries on from the other
+void SimpleEqAudioProcessor::switchQualityTier(bool offline, const ChainSettings& chainSettings, const ChainSettings& secondChainSettings)
+{
+    Trace::Scope traceScope { "switchQualityTier" };
+    
+    auto numChannels = juce::jmin(chains.size(), (int) offlineChains.size());
+    
+    if( offline )
+    {
+        setOfflineTargets(chainSettings, secondChainSettings);
+        
+        for( int c = 0; c < numChannels; ++c )
+        {
+            offlineChains[(size_t) c].skipSmoothing();
+            offlineChains[(size_t) c].copyStateFrom(chains.getSections(c), chains[c].state);
+        }
+    }
+    else
+    {
+        for( int c = 0; c < numChannels; ++c )
+            offlineChains[(size_t) c].copyStateTo(chains.getSections(c), chains[c].state);
+    }
+    
+    isOfflineTier = offline;
+}
+
+void SimpleEqAudioProcessor::setOfflineTargets(const ChainSettings& chainSettings, const ChainSettings& secondChainSettings)
+{
+    for( size_t c = 0; c < offlineChains.size(); ++c )
+        offlineChains[c].setTargets(c == 1 && stereoMode != StereoMode::Linked ? secondChainSettings : chainSettings);
+}
+
+void SimpleEqAudioProcessor::resetChains()
+{
+    chains.reset();
+    
+    for( auto& offlineChain : offlineChains )
+        offlineChain.reset();
+}
+
+void SimpleEqAudioProcessor::processSvf(juce::dsp::AudioBlock<float>& block)
+{
+    auto* left = block.getChannelPointer(0);
+    auto numSamples = (int) block.getNumSamples();
+    
+    if( block.getNumChannels() < 2 )
+    {
+        leftSvf.process(left, numSamples);
+        return;
+    }
+    
+    auto* right = block.getChannelPointer(1);
+    
+    if( stereoMode != StereoMode::MidSide )
+    {
+        leftSvf.process(left, numSamples);
+        rightSvf.process(right, numSamples);
+        return;
+    }
+    
+    for( int start = 0; start < numSamples; start += SvfChain::updateInterval )
+    {
+        auto numToProcess = juce::jmin(SvfChain::updateInterval, numSamples - start);
+        leftSvf.updateCoefficients(numToProcess);
+        rightSvf.updateCoefficients(numToProcess);
+        
+        for( int i = start; i < start + numToProcess; ++i )
+        {
+            auto mid = leftSvf.processSample((left[i] + right[i]) * 0.5f);
+            auto side = rightSvf.processSample((left[i] - right[i]) * 0.5f);
+            
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+    }
+}
+
+//a cc moved: the svf just gets new targets to glide to, the biquads get redesigned
+void SimpleEqAudioProcessor::applyBandChanges(int bandMask, const std::array<ChainSettings, 2>& chainSettings)
+{
+    for( int set = 0; set < 2; ++set )
+    {
+        auto setMask = (bandMask >> (set * NumChainPositions)) & ((1 << NumChainPositions) - 1);
+        
+        //linked runs everything on the first set, the R/S values wait until they mean something
+        if( setMask == 0 || (set == 1 && stereoMode == StereoMode::Linked) )
+            continue;
+        
+        auto& settings = chainSettings[(size_t) set];
+        
+        if( filterEngine == FilterEngine::SvfEngine )
+        {
+            svfSettings[(size_t) set] = settings;
+            (set == 0 ? leftSvf : rightSvf).setTargets(settings);
+            
+            if( stereoMode == StereoMode::Linked )
+            {
+                svfSettings[1] = settings;
+                rightSvf.setTargets(settings);
+            }
+            
+            continue;
+        }
+        
+        updateBands(setMask, settings, set);
+        
+        //same chains the biquad update reaches, the set's own one or all of them when linked
+        if( isOfflineTier )
+        {
+            for( size_t c = 0; c < offlineChains.size(); ++c )
+            {
+                if( (int) c == set || stereoMode == StereoMode::Linked )
+                    offlineChains[c].setTargets(settings);
+            }
+        }
+    }
+}
+
+void SimpleEqAudioProcessor::setStereoMode(StereoMode newMode)
+{
+    //the channels mean something else now, don't carry the old state over
+    if( newMode != stereoMode )
+        resetChains();
+
+    stereoMode = newMode;
+    chains.setLinked(stereoMode == StereoMode::Linked);
+}
+
+void SimpleEqAudioProcessor::updateBands(int bandMask, const ChainSettings& chainSettings, int channel)
+{
+    auto sampleRate = getSampleRate();
+    
+    if( bandMask & (1 << ChainPositions::LowCut) )
+        updateLowCutFilters(coefficientCache->getLowCutFilter(chainSettings, sampleRate), channel);
+    if( bandMask & (1 << ChainPositions::Peak) )
+        updatePeakFilter(coefficientCache->getPeakFilter(chainSettings, sampleRate), channel);
+    if( bandMask & (1 << ChainPositions::HighCut) )
+        updateHighCutFilters(coefficientCache->getHighCutFilter(chainSettings, sampleRate), channel);
+}
+
+void SimpleEqAudioProcessor::updateChain(const ChainCoefficients& chainCoefficients, int channel)
+{
+    updateLowCutFilters(chainCoefficients.lowCut, channel);
+    updatePeakFilter(chainCoefficients.peak, channel);
+    updateHighCutFilters(chainCoefficients.highCut, channel);
+}
+
+//everything the cache already has is used as is, if anything is missing
+//the whole lot goes through the batch designer in one pass and back into the cache
+void SimpleEqAudioProcessor::designChains(const ChainSettings* chainSettings, ChainCoefficients* results, int numChains)
+{
+    Trace::Scope traceScope { "designChains" };
+    
+    auto sampleRate = getSampleRate();
+    bool complete = true;
+    
+    for( int c = 0; c < numChains; ++c )
+    {
+        auto& settings = chainSettings[c];
+        auto& result = results[c];
+        
+        if( ! useBatchDesigner )
+        {
+            result.lowCut = coefficientCache->getLowCutFilter(settings, sampleRate);
+            result.peak = coefficientCache->getPeakFilter(settings, sampleRate);
+            result.highCut = coefficientCache->getHighCutFilter(settings, sampleRate);
+            continue;
+        }
+        
+        complete &= coefficientCache->findLowCutFilter(settings, sampleRate, result.lowCut);
+        complete &= coefficientCache->findPeakFilter(settings, sampleRate, result.peak);
+        complete &= coefficientCache->findHighCutFilter(settings, sampleRate, result.highCut);
+    }
+    
+    if( ! useBatchDesigner || complete )
+        return;
+    
+    batchDesigner.design(chainSettings, results, numChains, sampleRate);
+    
+    for( int c = 0; c < numChains; ++c )
+    {
+        coefficientCache->storeLowCutFilter(chainSettings[c], sampleRate, results[c].lowCut);
+        coefficientCache->storePeakFilter(chainSettings[c], sampleRate, results[c].peak);
+        coefficientCache->storeHighCutFilter(chainSettings[c], sampleRate, results[c].highCut);
+    }
+}
+
 //==============================================================================
 bool SimpleEqAudioProcessor::hasEditor() const
 {
@@ -203,125 +743,513 @@ void SimpleEqAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 
 void SimpleEqAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+    Trace::Scope traceScope { "setStateInformation" };
+    
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     if ( tree.isValid() )
     {
+        //sessions saved before the version was stored have the four 12 dB/Oct step slopes
+        if( (int) tree.getProperty("stateVersion", 1) < 2 )
+        {
+            for( auto child : tree )
+            {
+                if( child.hasType("PARAM") && child["id"].toString().endsWith("Slope") )
+                    child.setProperty("value", 2 * (int) child["value"] + 1, nullptr);
+            }
+        }
+
+        tree.setProperty("stateVersion", stateVersion, nullptr);
         apvts.replaceState(tree);
-        updateFilters();
+        
+        //not updateFilters() here, hosts load state from any thread while the audio runs.
+        //the next prepareToPlay or processBlock picks the new values up from the atomics
     }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+ChainSettings getChainSettings(const Parameters::Snapshot& parameters, int parameterSet)
 {
+    auto get = [&](Parameters::Index index) { return parameters[(size_t) Parameters::inSet(index, parameterSet)]; };
     ChainSettings settings;
     
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+    settings.lowCutFreq = get(Parameters::LowCutFreq);
+    settings.highCutFreq = get(Parameters::HighCutFreq);
+    settings.peakFreq = get(Parameters::PeakFreq);
+    settings.peakGainInDecibels = get(Parameters::PeakGain);
+    settings.peakQuality = get(Parameters::PeakQuality);
+    settings.lowCutSlope = static_cast<Slope>(get(Parameters::LowCutSlope));
+    settings.highCutSlope = static_cast<Slope>(get(Parameters::HighCutSlope));
+    settings.lowCutFamily = static_cast<CutFamily>(get(Parameters::LowCutFamily));
+    settings.highCutFamily = static_cast<CutFamily>(get(Parameters::HighCutFamily));
   
     return settings;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+ChainCoefficients getChainCoefficients(const ChainSections& sections)
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+    return { sections.getLowCut(), sections.getPeak(), sections.getHighCut() };
 }
 
-//Update peak settings
-void SimpleEqAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings)
+static double getPoleRadius(const BiquadCoefficients& c)
 {
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+    auto a1 = (double) c[4];
+    auto a2 = (double) c[5];
+    
+    //first order, the one pole is at -a1
+    if( a2 == 0.0 )
+        return std::abs(a1);
     
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    auto discriminant = a1 * a1 - 4.0 * a2;
+    
+    if( discriminant < 0.0 )
+        return std::sqrt(a2);
+    
+    return (std::abs(a1) + std::sqrt(discriminant)) * 0.5;
 }
 
-void updateCoefficients(Coefficients &old, const Coefficients &replacements)
+double getTailLengthSamples(const ChainSections& sections, float decayDb)
 {
-    *old = *replacements;
+    auto coefficients = getChainCoefficients(sections);
+    auto logDecay = std::log(juce::Decibels::decibelsToGain(-(double) decayDb));
+    double samples = 0.0;
+    
+    //each section rings on top of whatever the one before it left behind
+    auto add = [&](const BiquadCoefficients& section)
+    {
+        auto radius = getPoleRadius(section);
+        
+        if( radius > 0.0 )
+            samples += logDecay / std::log(juce::jmin(radius, 0.999999));
+    };
+    
+    for( int s = 0; s < coefficients.lowCut.numSections; ++s )
+        add(coefficients.lowCut[s]);
+    
+    add(coefficients.peak);
+    
+    for( int s = 0; s < coefficients.highCut.numSections; ++s )
+        add(coefficients.highCut[s]);
+    
+    return samples;
+}
+
+//an analog pole pair at g (the prewarped frequency, as tan(w / 2)) with the given Q, or a real pole
+//when quality is 0, through the bilinear transform z = (1 + s) / (1 - s). below Q 0.5 the slower pole rings longest
+static double getPoleRadius(double g, double quality)
+{
+    std::complex<double> pole = -1.0;
+    
+    if( quality > 0.0 )
+        pole = -0.5 / quality + std::sqrt(std::complex<double>(0.25 / (quality * quality) - 1.0, 0.0));
+    
+    return std::abs((1.0 + g * pole) / (1.0 - g * pole));
 }
 
-void SimpleEqAudioProcessor::updateLowCutFilters(const ChainSettings &chainSettings)
+double getTailLengthSamples(const ChainSettings& chainSettings, double sampleRate, float decayDb)
 {
-    auto cutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
-   
+    auto logDecay = std::log(juce::Decibels::decibelsToGain(-(double) decayDb));
+    auto warp = [sampleRate](double frequency)
+    {
+        return std::tan(juce::MathConstants<double>::pi * juce::jmin(frequency, 0.49 * sampleRate) / sampleRate);
+    };
+    
+    double samples = 0.0;
+    
+    auto add = [&](double radius)
+    {
+        if( radius > 0.0 )
+            samples += logDecay / std::log(juce::jmin(radius, 0.999999));
+    };
     
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
+    //the highpass transform inverts the prototype pole frequencies and keeps their Qs
+    auto addCut = [&](float frequency, Slope slope, CutFamily family, bool isHighPass)
+    {
+        auto& prototype = getCutPrototype(family, getCutFilterOrder(slope));
+        auto g = warp(frequency);
+        
+        for( int s = 0; s < prototype.numSections; ++s )
+        {
+            auto& section = prototype.sections[(size_t) s];
+            add(getPoleRadius(g * (isHighPass ? 1.0 / section.frequency : section.frequency), section.quality));
+        }
+    };
     
-    updateCutFilter(leftLowCut, cutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(rightLowCut, cutCoefficients, chainSettings.lowCutSlope);
+    addCut(chainSettings.lowCutFreq, chainSettings.lowCutSlope, chainSettings.lowCutFamily, true);
+    addCut(chainSettings.highCutFreq, chainSettings.highCutSlope, chainSettings.highCutFamily, false);
+    
+    //the rbj bell's poles have a Q of Q * A
+    auto A = std::pow(10.0, chainSettings.peakGainInDecibels / 40.0);
+    add(getPoleRadius(warp(chainSettings.peakFreq), chainSettings.peakQuality * A));
+    
+    return samples;
 }
 
-void SimpleEqAudioProcessor::updateHighCutFilters(const ChainSettings &chainSettings)
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+static int setCut(BiquadSection* sections, int& numSections, const CutCoefficients& cutCoefficients) noexcept
 {
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
+    jassert(cutCoefficients.numSections <= maxCutSections);
     
-    updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
+    for( int s = 0; s < cutCoefficients.numSections; ++s )
+        sections[s].setCoefficients(cutCoefficients[s]);
+    
+    auto previous = numSections;
+    numSections = cutCoefficients.numSections;
+    return previous;
 }
 
-void SimpleEqAudioProcessor::updateFilters()
+static CutCoefficients getCut(const BiquadSection* sections, int numSections)
 {
-    auto chainSettings = getChainSettings(apvts);
+    CutCoefficients result;
+    result.numSections = numSections;
+    
+    for( int s = 0; s < numSections; ++s )
+        result.sections[(size_t) s] = sections[s].getCoefficients();
     
-    updateLowCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
+    return result;
+}
+
+int ChainSections::setLowCut(const CutCoefficients& cutCoefficients) noexcept
+{
+    return setCut(sections.data(), numLowCutSections, cutCoefficients);
+}
+
+void ChainSections::setPeak(const BiquadCoefficients& peakCoefficients) noexcept
+{
+    sections[FilterKernels::peakSlot].setCoefficients(peakCoefficients);
+}
+
+int ChainSections::setHighCut(const CutCoefficients& cutCoefficients) noexcept
+{
+    return setCut(sections.data() + FilterKernels::highCutSlot, numHighCutSections, cutCoefficients);
+}
+
+CutCoefficients ChainSections::getLowCut() const
+{
+    return getCut(sections.data(), numLowCutSections);
+}
+
+CutCoefficients ChainSections::getHighCut() const
+{
+    return getCut(sections.data() + FilterKernels::highCutSlot, numHighCutSections);
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-juce::AudioProcessorValueTreeState::ParameterLayout
-    SimpleEqAudioProcessor::createParameterLayout()
+void ChainState::reset() noexcept
+{
+    for( auto& state : states )
+        state.reset();
+}
+
+void ChainState::snapToZero() noexcept
+{
+    for( auto& state : states )
+        state.snapToZero();
+}
+
+void ChainState::clear(int firstSlot, int endSlot) noexcept
+{
+    for( int s = firstSlot; s < endSlot; ++s )
+        states[(size_t) s].reset();
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void MonoChain::setLowCut(const CutCoefficients& cutCoefficients) noexcept
 {
-        juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    auto previous = sections.setLowCut(cutCoefficients);
+    state.clear(previous, cutCoefficients.numSections);
+}
+
+void MonoChain::setHighCut(const CutCoefficients& cutCoefficients) noexcept
+{
+    auto previous = sections.setHighCut(cutCoefficients);
+    state.clear(FilterKernels::highCutSlot + previous, FilterKernels::highCutSlot + cutCoefficients.numSections);
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ChainBlock::~ChainBlock()
+{
+    release();
+}
+
+void ChainBlock::allocate(int newNumChains)
+{
+    static_assert(sizeof(ChainSections) % alignof(MonoChain) == 0, "the first chain has to start on a cache line too");
+    
+    if( newNumChains != numChains )
+    {
+        release();
         
-        layout.add(std::make_unique<juce::AudioParameterFloat>("LowCut Freq",
-                                                               "LowCut Freq",
-                                                               juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20.f));
+        //the shared sections, then the chains, with room to slide the start up to the next cache line
+        memory.allocate(sizeof(ChainSections) + sizeof(MonoChain) * (size_t) newNumChains + alignof(MonoChain), false);
+        auto address = reinterpret_cast<std::uintptr_t>(memory.get());
+        auto aligned = (address + alignof(MonoChain) - 1) & ~(std::uintptr_t) (alignof(MonoChain) - 1);
+        linkedSections = new (reinterpret_cast<void*>(aligned)) ChainSections();
+        chains = reinterpret_cast<MonoChain*>(aligned + sizeof(ChainSections));
         
-        layout.add(std::make_unique<juce::AudioParameterFloat>("HighCut Freq",
-                                                               "HighCut Freq",
-                                                               juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20000.f));
+        for( int c = 0; c < newNumChains; ++c )
+            new (chains + c) MonoChain();
         
-        layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Freq",
-                                                               "Peak Freq",
-                                                               juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 750.f));
+        numChains = newNumChains;
+    }
+    
+    reset();
+}
+
+void ChainBlock::reset() noexcept
+{
+    for( int c = 0; c < numChains; ++c )
+        chains[c].reset();
+}
+
+void ChainBlock::clearStates(int index, int firstSlot, int endSlot) noexcept
+{
+    if( firstSlot >= endSlot )
+        return;
+    
+    if( ! linked )
+    {
+        chains[index].state.clear(firstSlot, endSlot);
+        return;
+    }
+    
+    for( int c = 0; c < numChains; ++c )
+        chains[c].state.clear(firstSlot, endSlot);
+}
+
+void ChainBlock::setLowCut(int index, const CutCoefficients& cutCoefficients) noexcept
+{
+    auto& sections = linked ? *linkedSections : (*this)[index].sections;
+    auto previous = sections.setLowCut(cutCoefficients);
+    clearStates(index, previous, cutCoefficients.numSections);
+}
+
+void ChainBlock::setPeak(int index, const BiquadCoefficients& peakCoefficients) noexcept
+{
+    (linked ? *linkedSections : (*this)[index].sections).setPeak(peakCoefficients);
+}
+
+void ChainBlock::setHighCut(int index, const CutCoefficients& cutCoefficients) noexcept
+{
+    auto& sections = linked ? *linkedSections : (*this)[index].sections;
+    auto previous = sections.setHighCut(cutCoefficients);
+    clearStates(index, FilterKernels::highCutSlot + previous, FilterKernels::highCutSlot + cutCoefficients.numSections);
+}
+
+void ChainBlock::setKernel(FilterKernels::Variant variant)
+{
+    kernel = FilterKernels::getKernel(variant);
+    laneWidth = FilterKernels::getLaneWidth(variant);
+    
+    for( int c = 0; c < numChains; ++c )
+        chains[c].setKernel(variant);
+}
+
+void ChainBlock::process(const juce::dsp::AudioBlock<float>& block, int first, int count) noexcept
+{
+    jassert(first >= 0 && first + count <= juce::jmin(numChains, (int) block.getNumChannels()));
+    
+    std::array<FilterKernels::Lane, FilterKernels::maxLanes> lanes;
+    auto numSamples = (int) block.getNumSamples();
+    
+    for( int start = first; start < first + count; start += FilterKernels::maxLanes )
+    {
+        auto numLanes = juce::jmin(FilterKernels::maxLanes, first + count - start);
         
-        layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Gain",
-                                                               "Peak Gain",
-                                                               juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.0f));
+        for( int l = 0; l < numLanes; ++l )
+        {
+            auto c = start + l;
+            lanes[(size_t) l] = getSections(c).makeLane(chains[c].state.states.data(), block.getChannelPointer((size_t) c));
+        }
         
-        layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Quality",
-                                                               "Peak Quality",
-                                                               juce::NormalisableRange<float>(0.1f, 10.f, 0.5f, 1.f), 1.f));
+        kernel(lanes.data(), numLanes, numSamples);
+    }
+    
+    for( int c = first; c < first + count; ++c )
+        chains[c].state.snapToZero();
+}
+
+void ChainBlock::release()
+{
+    for( int c = 0; c < numChains; ++c )
+        chains[c].~MonoChain();
+    
+    if( linkedSections != nullptr )
+        linkedSections->~ChainSections();
+    
+    memory.free();
+    linkedSections = nullptr;
+    chains = nullptr;
+    numChains = 0;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+double getMagnitudeForFrequency(const BiquadCoefficients& coefficients, double frequency, double sampleRate)
+{
+    auto z = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+    auto c = [&](int i) { return (double) coefficients[(size_t) i]; };
+    
+    return std::abs((c(0) + c(1) * z + c(2) * z * z) / (c(3) + c(4) * z + c(5) * z * z));
+}
+
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate)
+{
+    return { makeLowCutFilter(chainSettings, sampleRate),
+             makePeakFilter(chainSettings, sampleRate),
+             makeHighCutFilter(chainSettings, sampleRate) };
+}
+
+void setChainCoefficients(MonoChain& chain, const ChainCoefficients& chainCoefficients)
+{
+    chain.setLowCut(chainCoefficients.lowCut);
+    chain.setPeak(chainCoefficients.peak);
+    chain.setHighCut(chainCoefficients.highCut);
+}
+
+BiquadCoefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::IIR::ArrayCoefficients<float>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+}
+
+//designed in double and rounded once, no heap allocations
+static CutCoefficients makeCutFilter(float frequency, double sampleRate, Slope slope, CutFamily family, bool isHighPass)
+{
+    CutCoefficients cut;
+    auto& prototype = getCutPrototype(family, getCutFilterOrder(slope));
+    cut.numSections = prototype.numSections;
+
+    for( int i = 0; i < cut.numSections; ++i )
+    {
+        auto section = designCutSection(prototype.sections[(size_t) i], i == 0 ? prototype.gain : 1.0,
+                                         frequency, sampleRate, isHighPass);
+
+        for( size_t c = 0; c < section.size(); ++c )
+            cut.sections[(size_t) i][c] = (float) section[c];
+    }
+
+    return cut;
+}
+
+CutCoefficients makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return makeCutFilter(chainSettings.lowCutFreq, sampleRate, chainSettings.lowCutSlope, chainSettings.lowCutFamily, true);
+}
+
+CutCoefficients makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return makeCutFilter(chainSettings.highCutFreq, sampleRate, chainSettings.highCutSlope, chainSettings.highCutFamily, false);
+}
+
+//Update peak settings
+void SimpleEqAudioProcessor::updatePeakFilter(const BiquadCoefficients &peakCoefficients, int channel)
+{
+    Trace::Scope traceScope { "updatePeakFilter" };
+    
+    //linked, this is the one copy every chain reads
+    chains.setPeak(channel, peakCoefficients);
+}
+
+void SimpleEqAudioProcessor::updateLowCutFilters(const CutCoefficients &cutCoefficients, int channel)
+{
+    Trace::Scope traceScope { "updateLowCutFilters" };
+    
+    chains.setLowCut(channel, cutCoefficients);
+}
+
+void SimpleEqAudioProcessor::updateHighCutFilters(const CutCoefficients &highCutCoefficients, int channel)
+{
+    Trace::Scope traceScope { "updateHighCutFilters" };
+    
+    chains.setHighCut(channel, highCutCoefficients);
+}
+
+void SimpleEqAudioProcessor::updateFilters()
+{
+    Trace::Scope traceScope { "updateFilters" };
+    
+    //one pass over the atomics, everything below works from the same values
+    auto parameters = parameterValues.read();
+    auto mode = static_cast<StereoMode>(parameters[Parameters::StereoModeChoice]);
+    
+    //dual and m/s need a left and a right, any other bus runs every channel on the first set
+    if( getTotalNumOutputChannels() != 2 )
+        mode = StereoMode::Linked;
+    
+    if( mode != stereoMode )
+        setStereoMode(mode);
+    
+    auto chainSettings = getChainSettings(parameters, 0);
+    auto secondChainSettings = stereoMode == StereoMode::Linked ? chainSettings : getChainSettings(parameters, 1);
+    
+    auto engine = static_cast<FilterEngine>(parameters[Parameters::FilterEngineChoice]);
+    
+    //didn't pass the accuracy gate or the bus is too wide, the biquads stand in for it
+    //and the parameter says so
+    if( ! isSvfAvailable.load() )
+        engine = FilterEngine::BiquadEngine;
+    
+    if( engine == FilterEngine::SvfEngine )
+    {
+        //one tan() per band, nothing else gets designed while the svf runs
+        svfSettings = { chainSettings, secondChainSettings };
+        leftSvf.setTargets(chainSettings);
+        rightSvf.setTargets(secondChainSettings);
+    }
+    else
+    {
+        std::array<ChainSettings, 2> settings { chainSettings, secondChainSettings };
+        std::array<ChainCoefficients, 2> coefficients;
+        auto numChains = stereoMode == StereoMode::Linked ? 1 : 2;
         
-        juce::StringArray stringArray;
-        for(int i = 0; i < 4; ++i) {
-        juce::String str;
-            str << (12 + i*12);
-            str << " db/Oct";
-            stringArray.add(str);
-        }
+        designChains(settings.data(), coefficients.data(), numChains);
         
-        layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope",
-                                                                "LowCut Slope", stringArray, 0));
+        for( int c = 0; c < numChains; ++c )
+            updateChain(coefficients[(size_t) c], c);
+        
+        //bounces get the double precision chains, only worth it where nobody is waiting
+        if( isNonRealtime() != isOfflineTier )
+            switchQualityTier(isNonRealtime(), chainSettings, secondChainSettings);
+        else if( isOfflineTier )
+            setOfflineTargets(chainSettings, secondChainSettings);
+    }
+    
+    //the engine we switch to has been sitting idle, start it clean
+    if( engine != filterEngine )
+    {
+        if( engine == FilterEngine::SvfEngine )
+        {
+            leftSvf.reset();
+            rightSvf.reset();
+        }
+        else
+        {
+            resetChains();
+        }
         
-        layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope",
-                                                                "HighCut Slope", stringArray, 0));
+        filterEngine = engine;
+    }
+    
+    if( getSampleRate() > 0 )
+    {
+        if( filterEngine == FilterEngine::SvfEngine )
+            tailSamples = juce::jmax(getTailLengthSamples(svfSettings[0], getSampleRate(), -silenceThresholdDb),
+                                     getTailLengthSamples(svfSettings[1], getSampleRate(), -silenceThresholdDb));
+        else
+            tailSamples = juce::jmax(getTailLengthSamples(chains.getSections(0), -silenceThresholdDb),
+                                     getTailLengthSamples(chains.getSections(1), -silenceThresholdDb));
         
-        return layout;
+        tailSeconds.store(tailSamples / getSampleRate());
+    }
+}
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+juce::AudioProcessorValueTreeState::ParameterLayout
+    SimpleEqAudioProcessor::createParameterLayout()
+{
+    //built from the descriptor table in Parameters.h
+    return Parameters::createLayout([this] { return isSvfAvailable.load(); });
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //==============================================================================
@@ -9,15 +9,39 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "MidiCCMap.h"
+#include "SvfFilter.h"
+#include "CutPrototype.h"
+#include "Parameters.h"
+#include "Trace.h"
+#include "FilterKernels.h"
+#include "ChannelWorkers.h"
+#include "OfflineChain.h"
+#include "BatchDesigner.h"
+
+struct CoefficientCache;
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+//one step per filter order
 enum Slope
 {
+    Slope_6,
     Slope_12,
+    Slope_18,
     Slope_24,
+    Slope_30,
     Slope_36,
-    Slope_48
+    Slope_42,
+    Slope_48,
+    Slope_54,
+    Slope_60,
+    Slope_66,
+    Slope_72,
+    Slope_78,
+    Slope_84,
+    Slope_90,
+    Slope_96
 };
 
 struct ChainSettings
@@ -25,79 +49,261 @@ struct ChainSettings
     float peakFreq { 0 }, peakGainInDecibels{ 0 }, peakQuality {1.f};
     float lowCutFreq { 0 }, highCutFreq { 0 };
     Slope lowCutSlope { Slope::Slope_12 }, highCutSlope { Slope::Slope_12 };
+    CutFamily lowCutFamily { CutFamily::Butterworth }, highCutFamily { CutFamily::Butterworth };
 };
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+//how the two channels are filtered
+//Linked: one set of settings for L/R, Mid/Side and DualMono: the second set drives side / right
+enum StereoMode
+{
+    Linked,
+    MidSide,
+    DualMono
+};
+
+//which realization of the chain processes the audio
+//Biquad: the juce IIR filters, Svf: the TPT state variable filters, cheap to modulate
+enum FilterEngine
+{
+    BiquadEngine,
+    SvfEngine
+};
+
+//parameterSet 0 is left / mid (and both in linked mode), 1 is right / side
+ChainSettings getChainSettings(const Parameters::Snapshot& parameters, int parameterSet = 0);
+
+//filter order for a slope setting, every 6 dB/Oct is one pole
+inline int getCutFilterOrder(Slope slope) { return slope + 1; }
 
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-//  aliases for the namespaces
-using Filter = juce::dsp::IIR::Filter<float>;
+//first order sections are biquads with b2 and a2 at 0
+struct CutCoefficients
+{
+    const BiquadCoefficients& operator[](int index) const { return sections[(size_t) index]; }
 
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+    std::array<BiquadCoefficients, maxCutSections> sections {};
+    int numSections { 0 };
+};
 
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+static_assert(maxCutSections <= FilterKernels::maxSections, "the kernels can't run the longest cut in one go");
 
-enum ChainPositions
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  the coefficients of one chain, each section at its kernel slot (see FilterKernels.h).
+//  a chain of its own keeps one of these, linked chains all read the one in their ChainBlock
+struct alignas(64) ChainSections
 {
-    LowCut,
-    Peak,
-    HighCut
+    //the cut setters return how many sections the band ran before,
+    //so whoever keeps the state can clear what wasn't running
+    int setLowCut(const CutCoefficients& cutCoefficients) noexcept;
+    void setPeak(const BiquadCoefficients& peakCoefficients) noexcept;
+    int setHighCut(const CutCoefficients& cutCoefficients) noexcept;
+
+    //normalised, a0 is 1
+    CutCoefficients getLowCut() const;
+    BiquadCoefficients getPeak() const { return sections[FilterKernels::peakSlot].getCoefficients(); }
+    CutCoefficients getHighCut() const;
+
+    int getNumLowCutSections() const noexcept { return numLowCutSections; }
+    int getNumHighCutSections() const noexcept { return numHighCutSections; }
+
+    const BiquadSection& operator[](int slot) const noexcept { return sections[(size_t) slot]; }
+
+    FilterKernels::Lane makeLane(BiquadState* states, float* samples) const noexcept
+    {
+        return { sections.data(), states, numLowCutSections, numHighCutSections, samples };
+    }
+
+private:
+    std::array<BiquadSection, FilterKernels::numSlots> sections;
+    int numLowCutSections { 0 }, numHighCutSections { 0 };
 };
 
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+//what every section of one chain remembers, slot for slot with its ChainSections
+struct ChainState
+{
+    std::array<BiquadState, FilterKernels::numSlots> states;
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+    void reset() noexcept;
+    void snapToZero() noexcept;
 
-//helper function for update coefficients
+    //slots [firstSlot, endSlot), for sections that just started running
+    void clear(int firstSlot, int endSlot) noexcept;
 
+    BiquadState& operator[](int slot) noexcept { return states[(size_t) slot]; }
+    const BiquadState& operator[](int slot) const noexcept { return states[(size_t) slot]; }
+};
 
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, const CoefficientType& coefficients)
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  one channel's filters, its own coefficients and its state inline, starting on a
+//  cache line. nothing in here points anywhere else. inside a linked ChainBlock only
+//  the state is used, the sections are the block's
+struct alignas(64) MonoChain
 {
-    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-    chain.template setBypassed<Index>(false);
-}
+    ChainSections sections;
+    ChainState state;
+
+    //picked once per prepareToPlay, every block of this chain goes through it
+    FilterKernels::Kernel kernel { FilterKernels::getKernel(FilterKernels::Generic) };
+
+    void prepare(const juce::dsp::ProcessSpec&) noexcept { reset(); }
+    void setKernel(FilterKernels::Variant variant) { kernel = FilterKernels::getKernel(variant); }
+    void reset() noexcept { state.reset(); }
+
+    //sections that weren't running before start from clear state
+    void setLowCut(const CutCoefficients& cutCoefficients) noexcept;
+    void setPeak(const BiquadCoefficients& peakCoefficients) noexcept { sections.setPeak(peakCoefficients); }
+    void setHighCut(const CutCoefficients& cutCoefficients) noexcept;
+
+    FilterKernels::Lane makeLane(float* samples) noexcept { return sections.makeLane(state.states.data(), samples); }
+
+    template<typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        auto& inputBlock = context.getInputBlock();
+        auto& outputBlock = context.getOutputBlock();
+        jassert(inputBlock.getNumChannels() == 1 && outputBlock.getNumChannels() == 1);
+
+        auto* input = inputBlock.getChannelPointer(0);
+        auto* output = outputBlock.getChannelPointer(0);
+        auto numSamples = (int) outputBlock.getNumSamples();
 
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& leftLowCut, const CoefficientType& cutCoefficients, const Slope& lowCutSlope)
+        if( input != output )
+            std::copy(input, input + numSamples, output);
+
+        if( context.isBypassed )
+            return;
+
+        auto lane = makeLane(output);
+        kernel(&lane, 1, numSamples);
+        state.snapToZero();
+    }
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  every chain of a processor in one cache line aligned allocation: the sections linked
+//  chains share, then chain after chain. a linked band is designed into the shared sections
+//  once and every chain reads it from there, each keeping only its own state.
+//  aligned by hand rather than with aligned new, which needs macOS 10.14 and the mac
+//  exporter targets 10.11. nothing over-aligned is allocated with plain new anywhere
+class ChainBlock
 {
-    leftLowCut.template setBypassed<0>(true);
-    leftLowCut.template setBypassed<1>(true);
-    leftLowCut.template setBypassed<2>(true);
-    leftLowCut.template setBypassed<3>(true);
-    
-    switch( lowCutSlope )
+public:
+    explicit ChainBlock(int numChains) { allocate(numChains); }
+    ~ChainBlock();
+
+    //only reallocates if the number of chains changes, the chains come back reset either way
+    void allocate(int numChains);
+    void reset() noexcept;
+
+    //linked, every chain runs the shared sections and the chain index of the setters is ignored
+    void setLinked(bool shouldBeLinked) noexcept { linked = shouldBeLinked; }
+    bool isLinked() const noexcept { return linked; }
+
+    //what the chain runs, the shared sections when linked
+    const ChainSections& getSections(int index) const noexcept
     {
-        case Slope_48:
-        {
-            update<3>(leftLowCut, cutCoefficients);
-        }
-        case Slope_36:
-        {
-            update<2>(leftLowCut, cutCoefficients);
-        }
-        case Slope_24:
-        {
-            update<1>(leftLowCut, cutCoefficients);
-        }
-        case Slope_12:
-        {
-            update<0>(leftLowCut, cutCoefficients);
-        }
+        return linked ? *linkedSections : (*this)[index].sections;
     }
-}
 
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate )
+    //one write however many chains read it. sections that weren't running
+    //start from clear state in every chain that runs them now
+    void setLowCut(int index, const CutCoefficients& cutCoefficients) noexcept;
+    void setPeak(int index, const BiquadCoefficients& peakCoefficients) noexcept;
+    void setHighCut(int index, const CutCoefficients& cutCoefficients) noexcept;
+
+    //picked once per prepareToPlay, process() hands it the chains a lane width at a time
+    void setKernel(FilterKernels::Variant variant);
+    int getLaneWidth() const noexcept { return laneWidth; }
+
+    //channels [first, first + count) of block, each through its own chain
+    void process(const juce::dsp::AudioBlock<float>& block, int first, int count) noexcept;
+
+    MonoChain& operator[](int index) noexcept { jassert(juce::isPositiveAndBelow(index, numChains)); return chains[index]; }
+    const MonoChain& operator[](int index) const noexcept { jassert(juce::isPositiveAndBelow(index, numChains)); return chains[index]; }
+
+    int size() const noexcept { return numChains; }
+
+private:
+    juce::HeapBlock<char> memory;
+    ChainSections* linkedSections { nullptr };
+    MonoChain* chains { nullptr };
+    int numChains { 0 };
+    bool linked { true };
+
+    FilterKernels::Kernel kernel { FilterKernels::getKernel(FilterKernels::Generic) };
+    int laneWidth { 1 };
+
+    //the chains reading the sections of index, and the slots to clear in them
+    void clearStates(int index, int firstSlot, int endSlot) noexcept;
+    void release();
+
+    JUCE_DECLARE_NON_COPYABLE(ChainBlock)
+};
+
+enum ChainPositions
+{
+    LowCut,
+    Peak,
+    HighCut,
+    NumChainPositions
+};
+
+//every section of one chain
+struct ChainCoefficients
 {
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 2 * (chainSettings.lowCutSlope + 1));
-}
+    CutCoefficients lowCut;
+    BiquadCoefficients peak {};
+    CutCoefficients highCut;
+};
+
+//what a chain is running right now, normalised
+ChainCoefficients getChainCoefficients(const ChainSections& sections);
 
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate )
+//samples until the impulse response of the chain has decayed by decayDb,
+//worked out from the pole radius of every section in the cascade
+double getTailLengthSamples(const ChainSections& sections, float decayDb);
+
+//the same straight from the settings, the poles are mapped across from the prototypes
+//without designing any coefficients. for the svf engine, which has no biquads to ask
+double getTailLengthSamples(const ChainSettings& chainSettings, double sampleRate, float decayDb);
+
+//what the audio thread is running, both chains, published for the editor
+//so it never has to design anything itself
+struct CoefficientSnapshot
 {
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, 2 * (chainSettings.highCutSlope + 1));
-}
+    std::array<ChainCoefficients, 2> chains {};
+    StereoMode stereoMode { StereoMode::Linked };
+    
+    //the engine that's running. the svf has no biquads of its own, chains holds the ones
+    //with the same response, designed on the audio thread whenever its settings move
+    FilterEngine engine { FilterEngine::BiquadEngine };
+    std::array<ChainSettings, 2> settings {};
+    double sampleRate { 0.0 };
+
+    //0 until the first publish, goes up by one with every change
+    juce::uint32 version { 0 };
+};
+
+//magnitude response of a single section, worked out in double precision
+double getMagnitudeForFrequency(const BiquadCoefficients& coefficients, double frequency, double sampleRate);
+
+//the scalar designs of every band
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate);
+
+//a chain that owns its coefficients, for anything outside the processor
+void setChainCoefficients(MonoChain& chain, const ChainCoefficients& chainCoefficients);
+
+//m/s encode, both chains and the decode as separate passes over the channels
+void processMidSideSeparately(MonoChain& midChain, MonoChain& sideChain, float* left, float* right, int numSamples);
+
+//the same, with encode, both chains and the decode in one loop over the samples
+void processMidSideFused(MonoChain& midChain, MonoChain& sideChain, float* left, float* right, int numSamples);
+
+BiquadCoefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+
+CutCoefficients makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate);
+CutCoefficients makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate);
 //==============================================================================
 /**
 */
@@ -146,25 +352,138 @@ public:
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //  creating the parameter layout
 
-    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    //the engine choice asks the processor what it would run, so it isn't static
+    juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
     juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameterLayout()};
+
+    //the atomics behind apvts, looked up once here rather than by ID every block
+    const Parameters::Values parameterValues { apvts };
+
+    //design the neighbourhood of the current settings into the shared cache in prepareToPlay
+    void setCoefficientPrewarming(bool shouldPrewarm) { prewarmCoefficients = shouldPrewarm; }
+
+    //share of blocks skipped because input and filter state were both silent
+    double getSkippedBlockFraction() const;
+
+    //the filter kernel the last prepareToPlay picked, see FilterKernels.h
+    FilterKernels::Variant getKernelVariant() const { return kernelVariant; }
+
+    //threads to spread buses of ChannelWorkers::minChannels or more over, 0 runs them all
+    //on the audio thread. takes effect at the next prepareToPlay
+    void setChannelWorkers(int numWorkers) { numChannelWorkers = numWorkers; }
+    ChannelWorkers::Stats getChannelWorkerStats() const;
+
+    //true while the host renders offline and the biquads run the double precision chains
+    bool isUsingOfflineTier() const { return isOfflineTier; }
+
+    //copies the latest published coefficients if their version differs from the one in snapshot,
+    //lock-free on both sides: if the audio thread is mid publish it returns false, ask again later
+    bool getSnapshotIfNewer(CoefficientSnapshot& snapshot) const;
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     
 private:
-    //stereo processing
-    MonoChain leftChain, rightChain;
+    //any layout up to this wide, the stereo modes only mean something on a stereo bus
+    static constexpr int maxChannels = 64;
+
+    //one chain per channel, never fewer than two so the stereo modes always have both
+    static constexpr int minChains = 2;
+
+    //stereo processing, 0 is left / mid and 1 is right / side.
+    //every chain shares one aligned block, sized again in prepareToPlay.
+    //linked mode designs the first chain and copies its sections across
+    ChainBlock chains { minChains };
+    StereoMode stereoMode { StereoMode::Linked };
+    FilterKernels::Variant kernelVariant { FilterKernels::Generic };
+
+    //wide buses only, and only when asked for
+    int numChannelWorkers { ChannelWorkers::getDefaultNumWorkers() };
+    std::unique_ptr<ChannelWorkers> channelWorkers;
+
+    //one per chain, they take over from the float chains while isNonRealtime() is set.
+    //the float chains stay designed underneath, the tail length and the editor come from them
+    std::vector<OfflineChain> offlineChains;
+    bool isOfflineTier { false };
+
+    void switchQualityTier(bool offline, const ChainSettings& chainSettings, const ChainSettings& secondChainSettings);
+    void setOfflineTargets(const ChainSettings& chainSettings, const ChainSettings& secondChainSettings);
+    void processOffline(juce::dsp::AudioBlock<float>& block);
+    void resetChains();
+
+    //the fused m/s loop and the svf engine only run where they passed the AccuracyGate,
+    //the svf only on up to two channels. the engine parameter's text reads it from any thread
+    bool useFusedMidSide { true };
+    std::atomic<bool> isSvfAvailable { true };
+
+    void setStereoMode(StereoMode newMode);
+    void processMidSide(juce::dsp::AudioBlock<float>& block);
+
+    //the svf version of the same two chains, only kept up to date while it's the selected engine.
+    //the biquads aren't designed while it runs, they catch up when the engine switches back
+    SvfChain leftSvf, rightSvf;
+    FilterEngine filterEngine { FilterEngine::BiquadEngine };
+    std::array<ChainSettings, 2> svfSettings {};
+
+    void processSvf(juce::dsp::AudioBlock<float>& block);
+    void applyBandChanges(int bandMask, const std::array<ChainSettings, 2>& chainSettings);
+
+    //records a timeline when SIMPLEEQ_TRACE names a file, see Trace.h
+    juce::SharedResourcePointer<Trace::Session> traceSession;
+
+    //midi cc -> parameter mapping, applied sample accurately in processBlock
+    MidiCCMap midiCCMap { apvts };
+
+    //shared by every instance in the process
+    juce::SharedResourcePointer<CoefficientCache> coefficientCache;
+    bool prewarmCoefficients { true };
+
+    //designs the cache misses of both chains in one go, only used where the
+    //recorded AccuracyGate run passed it
+    BatchDesigner batchDesigner;
+    bool useBatchDesigner { false };
+
+    void designChains(const ChainSettings* chainSettings, ChainCoefficients* results, int numChains);
+
+    //cc events closer together than this are folded into one coefficient update
+    static constexpr int midiSegmentGranularity = 8;
+
+    //once the input has been silent for longer than the filters ring, the chains are skipped
+    static constexpr float silenceThresholdDb = -120.f;
+    std::atomic<double> tailSeconds { 0.0 };
+    double tailSamples { 0.0 };
+    juce::int64 silentSamples { 0 };
+    float lastOutputLevel { 0.f };
+    bool isIdle { false };
+    std::atomic<juce::int64> numBlocks { 0 }, numSkippedBlocks { 0 };
+
+    bool skipSilentBlock(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midiMessages);
+
+    //single writer seqlock: the audio thread (or prepareToPlay) is the only publisher,
+    //the sequence is odd while the snapshot is being rewritten
+    CoefficientSnapshot snapshot;
+    std::atomic<juce::uint32> snapshotSequence { 0 };
+
+    void publishSnapshot();
+
+    void processSegment(juce::dsp::AudioBlock<float> block);
+    void updateBands(int bandMask, const ChainSettings& chainSettings, int channel);
+        
+    void updateChain(const ChainCoefficients& chainCoefficients, int channel);
         
     //Update the peak filter with chain settings
-    void updatePeakFilter(const ChainSettings& chainSettings);
+    void updatePeakFilter(const BiquadCoefficients& peakCoefficients, int channel);
     
    
     
     //update all the filters
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    void updateLowCutFilters(const CutCoefficients& cutCoefficients, int channel);
+    void updateHighCutFilters(const CutCoefficients& cutCoefficients, int channel);
 
     void updateFilters();
+
+    //goes up when a saved parameter changes meaning, older states are converted on load.
+    //2: slopes went from 12 dB/Oct steps (12..48) to 6 dB/Oct steps (6..96)
+    static constexpr int stateVersion = 2;
     
     
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
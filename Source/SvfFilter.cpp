@@ -0,0 +1,180 @@
+/*
+  ==============================================================================
+
+    SvfFilter.cpp
+    Topology-preserving-transform state variable filter version of the chain.
+
+  ==============================================================================
+*/
+
+#include "SvfFilter.h"
+#include "PluginProcessor.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void SvfSection::setIntegrators(float g, float k)
+{
+    a1 = 1.f / (1.f + g * (g + k));
+    a2 = g * a1;
+    a3 = g * a2;
+}
+
+void SvfSection::setLowPass(float g, float k, float gain)
+{
+    setIntegrators(g, k);
+    m0 = 0.f;
+    m1 = 0.f;
+    m2 = gain;
+}
+
+void SvfSection::setHighPass(float g, float k, float gain)
+{
+    setIntegrators(g, k);
+    m0 = gain;
+    m1 = -k * gain;
+    m2 = -gain;
+}
+
+//1 / (s + 1) = (s + 1) / (s + 1)^2, band + low
+void SvfSection::setFirstOrderLowPass(float g, float gain)
+{
+    setIntegrators(g, 2.f);
+    m0 = 0.f;
+    m1 = gain;
+    m2 = gain;
+}
+
+//s / (s + 1) = s (s + 1) / (s + 1)^2, high + band
+void SvfSection::setFirstOrderHighPass(float g, float gain)
+{
+    setIntegrators(g, 2.f);
+    m0 = gain;
+    m1 = -gain;
+    m2 = -gain;
+}
+
+void SvfSection::setBell(float g, float k, float A)
+{
+    setIntegrators(g, k);
+    m0 = 1.f;
+    m1 = k * (A * A - 1.f);
+    m2 = 0.f;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void SvfChain::CutCascade::setPrototype(const CutPrototype& prototype)
+{
+    //sections that were switched off come back without stale state
+    for( int s = numSections; s < prototype.numSections; ++s )
+        sections[(size_t) s].reset();
+
+    for( int s = 0; s < prototype.numSections; ++s )
+    {
+        auto& section = prototype.sections[(size_t) s];
+        scale[(size_t) s] = (float) (isHighPass ? 1.0 / section.frequency : section.frequency);
+        damping[(size_t) s] = section.quality == 0.0 ? 0.f : (float) (1.0 / section.quality);
+    }
+
+    gain = (float) prototype.gain;
+    numSections = prototype.numSections;
+}
+
+void SvfChain::CutCascade::updateCoefficients(float warpedFrequency)
+{
+    for( int s = 0; s < numSections; ++s )
+    {
+        auto& section = sections[(size_t) s];
+        auto g = warpedFrequency * scale[(size_t) s];
+        auto k = damping[(size_t) s];
+        auto sectionGain = s == 0 ? gain : 1.f;
+
+        if( k == 0.f && isHighPass )
+            section.setFirstOrderHighPass(g, sectionGain);
+        else if( k == 0.f )
+            section.setFirstOrderLowPass(g, sectionGain);
+        else if( isHighPass )
+            section.setHighPass(g, k, sectionGain);
+        else
+            section.setLowPass(g, k, sectionGain);
+    }
+}
+
+void SvfChain::CutCascade::reset()
+{
+    for( auto& section : sections )
+        section.reset();
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void SvfChain::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    //fast enough to follow automation, slow enough to not zip
+    lowCutFreq.reset(sampleRate, 0.02);
+    highCutFreq.reset(sampleRate, 0.02);
+    peakFreq.reset(sampleRate, 0.02);
+    peakGain.reset(sampleRate, 0.02);
+    peakQuality.reset(sampleRate, 0.02);
+
+    reset();
+}
+
+void SvfChain::reset()
+{
+    lowCutFreq.setCurrentAndTargetValue(lowCutFreq.getTargetValue());
+    highCutFreq.setCurrentAndTargetValue(highCutFreq.getTargetValue());
+    peakFreq.setCurrentAndTargetValue(peakFreq.getTargetValue());
+    peakGain.setCurrentAndTargetValue(peakGain.getTargetValue());
+    peakQuality.setCurrentAndTargetValue(peakQuality.getTargetValue());
+
+    lowCut.reset();
+    highCut.reset();
+    peak.reset();
+
+    updateCoefficients(0);
+}
+
+void SvfChain::setTargets(const ChainSettings& chainSettings)
+{
+    lowCutFreq.setTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setTargetValue(chainSettings.highCutFreq);
+    peakFreq.setTargetValue(chainSettings.peakFreq);
+    peakGain.setTargetValue(chainSettings.peakGainInDecibels);
+    peakQuality.setTargetValue(chainSettings.peakQuality);
+
+    lowCut.setPrototype(getCutPrototype(chainSettings.lowCutFamily, getCutFilterOrder(chainSettings.lowCutSlope)));
+    highCut.setPrototype(getCutPrototype(chainSettings.highCutFamily, getCutFilterOrder(chainSettings.highCutSlope)));
+}
+
+float SvfChain::getWarpedFrequency(float frequency) const
+{
+    //bilinear prewarping, kept clear of nyquist
+    auto normalised = juce::jmin((double) frequency / sampleRate, 0.49);
+    return (float) std::tan(juce::MathConstants<double>::pi * normalised);
+}
+
+void SvfChain::updateCoefficients(int numSamplesAhead)
+{
+    auto lowCutG = getWarpedFrequency(lowCutFreq.skip(numSamplesAhead));
+    auto highCutG = getWarpedFrequency(highCutFreq.skip(numSamplesAhead));
+    auto peakG = getWarpedFrequency(peakFreq.skip(numSamplesAhead));
+
+    lowCut.updateCoefficients(lowCutG);
+    highCut.updateCoefficients(highCutG);
+
+    auto A = juce::Decibels::decibelsToGain(peakGain.skip(numSamplesAhead) * 0.5f);
+    auto Q = peakQuality.skip(numSamplesAhead);
+    peak.setBell(peakG, 1.f / (Q * A), A);
+}
+
+void SvfChain::process(float* samples, int numSamples)
+{
+    for( int start = 0; start < numSamples; start += updateInterval )
+    {
+        auto numToProcess = juce::jmin(updateInterval, numSamples - start);
+        updateCoefficients(numToProcess);
+
+        for( int i = start; i < start + numToProcess; ++i )
+            samples[i] = processSample(samples[i]);
+    }
+}
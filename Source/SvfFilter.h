@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    SvfFilter.h
+    Topology-preserving-transform state variable filter version of the chain.
+
+    Same responses as the biquads (same bilinear prewarping), but the state
+    lives in the integrators instead of the direct form delays, so the
+    coefficients can move every few samples without zipper noise or blowing
+    up, and working them out is one tan() per band.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CutPrototype.h"
+
+struct ChainSettings;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  Simper / Cytomic trapezoidal svf, output = m0 * in + m1 * band + m2 * low
+struct SvfSection
+{
+    float a1 { 1.f }, a2 { 0.f }, a3 { 0.f };
+    float m0 { 1.f }, m1 { 0.f }, m2 { 0.f };
+    float ic1eq { 0.f }, ic2eq { 0.f };
+
+    void setLowPass(float g, float k, float gain = 1.f);
+    void setHighPass(float g, float k, float gain = 1.f);
+
+    //one pole versions, k = 2 puts both poles at the cutoff and one of them is cancelled
+    void setFirstOrderLowPass(float g, float gain = 1.f);
+    void setFirstOrderHighPass(float g, float gain = 1.f);
+    //k here is 1 / (Q * A), A the square root of the linear gain
+    void setBell(float g, float k, float A);
+
+    void reset() { ic1eq = ic2eq = 0.f; }
+
+    inline float processSample(float v0) noexcept
+    {
+        auto v3 = v0 - ic2eq;
+        auto v1 = a1 * ic1eq + a2 * v3;
+        auto v2 = ic2eq + a2 * ic1eq + a3 * v3;
+        ic1eq = 2.f * v1 - ic1eq;
+        ic2eq = 2.f * v2 - ic2eq;
+
+        return m0 * v0 + m1 * v1 + m2 * v2;
+    }
+
+private:
+    void setIntegrators(float g, float k);
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//  low cut cascade -> peak -> high cut cascade, parameters smoothed and
+//  coefficients recomputed every updateInterval samples
+struct SvfChain
+{
+    static constexpr int updateInterval = 8;
+
+    void prepare(double sampleRate);
+
+    //jump straight to the targets and clear the state
+    void reset();
+
+    void setTargets(const ChainSettings& chainSettings);
+
+    void process(float* samples, int numSamples);
+
+    //for loops that run the chain one sample at a time (mid/side),
+    //call updateCoefficients at least every updateInterval samples
+    void updateCoefficients(int numSamplesAhead);
+
+    inline float processSample(float sample) noexcept
+    {
+        return highCut.processSample(peak.processSample(lowCut.processSample(sample)));
+    }
+
+private:
+    //one cut cascade with the constants of its prototype, worked out when the slope or family is set
+    struct CutCascade
+    {
+        explicit CutCascade(bool shouldBeHighPass) : isHighPass(shouldBeHighPass) {}
+
+        std::array<SvfSection, maxCutSections> sections;
+        std::array<float, maxCutSections> scale {}, damping {};     //damping 0 is a first order section
+        float gain { 1.f };
+        int numSections { 0 };
+        const bool isHighPass;
+
+        void setPrototype(const CutPrototype& prototype);
+        void updateCoefficients(float warpedFrequency);
+        void reset();
+
+        inline float processSample(float sample) noexcept
+        {
+            for( int s = 0; s < numSections; ++s )
+                sample = sections[(size_t) s].processSample(sample);
+
+            return sample;
+        }
+    };
+
+    CutCascade lowCut { true }, highCut { false };
+    SvfSection peak;
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> lowCutFreq { 20.f }, highCutFreq { 20000.f }, peakFreq { 750.f };
+    juce::SmoothedValue<float> peakGain { 0.f }, peakQuality { 1.f };
+
+    double sampleRate { 44100.0 };
+
+    float getWarpedFrequency(float frequency) const;
+};
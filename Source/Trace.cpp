@@ -0,0 +1,241 @@
+/*
+  ==============================================================================
+
+    Trace.cpp
+    Optional timeline of what the audio and GUI threads were doing.
+
+  ==============================================================================
+*/
+
+#include "Trace.h"
+
+namespace Trace
+{
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//threads past this many just don't get recorded
+static constexpr int maxThreads = 32;
+
+//a couple of seconds of 128 sample blocks at 48k with every scope in them, it gets drained ten times a second
+static constexpr juce::uint32 eventsPerThread = 1 << 13;
+
+struct Event
+{
+    const char* name;
+    juce::int64 ticks;
+    bool isBegin;
+};
+
+//single producer (the thread that claimed it), single consumer (the flush thread)
+struct Session::ThreadBuffer
+{
+    std::array<Event, eventsPerThread> events;
+    std::atomic<juce::uint32> writeIndex { 0 }, readIndex { 0 };
+    std::atomic<juce::uint32> numDropped { 0 };
+    bool isMessageThread { false };
+
+    //flush thread only
+    bool isNamed { false };
+
+    void push(const char* name, bool isBegin) noexcept
+    {
+        auto write = writeIndex.load(std::memory_order_relaxed);
+
+        //full, the flush thread is behind. an end without its begin still nests fine in the viewer
+        if( write - readIndex.load(std::memory_order_acquire) == eventsPerThread )
+        {
+            numDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        events[write % eventsPerThread] = { name, juce::Time::getHighResolutionTicks(), isBegin };
+        writeIndex.store(write + 1, std::memory_order_release);
+    }
+};
+
+static std::mutex outputFileLock;
+static bool hasOutputFile = false;
+static juce::File outputFile;
+
+static std::atomic<Session*> activeSession { nullptr };
+static std::atomic<int> sessionSerial { 0 };
+
+//scopes that saw a session and may still write to its rings, the session waits for these to close
+static std::atomic<int> openScopes { 0 };
+
+//which buffer this thread claimed, and in which session
+struct ThreadClaim
+{
+    int serial { 0 };
+    Session::ThreadBuffer* buffer { nullptr };
+};
+
+static thread_local ThreadClaim threadClaim;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void setOutputFile(const juce::File& file)
+{
+    std::lock_guard<std::mutex> lock(outputFileLock);
+    outputFile = file;
+    hasOutputFile = true;
+}
+
+Session::Session() : juce::Thread("Trace flush")
+{
+    {
+        std::lock_guard<std::mutex> lock(outputFileLock);
+
+        if( hasOutputFile )
+            file = outputFile;
+        else if( auto path = juce::SystemStats::getEnvironmentVariable("SIMPLEEQ_TRACE", {}); path.isNotEmpty() )
+            file = juce::File::getCurrentWorkingDirectory().getChildFile(path);
+    }
+
+    if( file == juce::File() )
+        return;
+
+    file.deleteFile();
+    stream = std::make_unique<juce::FileOutputStream>(file);
+
+    if( stream->failedToOpen() )
+    {
+        DBG("couldn't open the trace file " << file.getFullPathName());
+        stream.reset();
+        return;
+    }
+
+    //the array is left open while recording, the viewers take it either way
+    *stream << "[\n";
+
+    threads = std::make_unique<ThreadBuffer[]>(maxThreads);
+    startTicks = juce::Time::getHighResolutionTicks();
+    serial = sessionSerial.fetch_add(1) + 1;
+    activeSession.store(this, std::memory_order_release);
+
+    startThread();
+}
+
+Session::~Session()
+{
+    if( ! isRecording() )
+        return;
+
+    activeSession.store(nullptr);
+
+    //a scope that loaded the session before the store above can still be pushing its end event
+    while( openScopes.load() != 0 )
+        juce::Thread::yield();
+
+    stopThread(1000);
+    drain();
+
+    for( int t = 0; t < numThreads.load(); ++t )
+    {
+        if( auto dropped = threads[(size_t) t].numDropped.load() )
+            DBG("trace: thread " << t << " dropped " << (int) dropped << " events");
+    }
+
+    *stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"SimpleEq\"}}\n]\n";
+    stream->flush();
+}
+
+Session::ThreadBuffer* Session::getThreadBuffer() noexcept
+{
+    if( threadClaim.serial == serial )
+        return threadClaim.buffer;
+
+    auto index = numThreads.fetch_add(1);
+
+    if( index >= maxThreads )
+    {
+        numThreads.store(maxThreads);
+        return nullptr;
+    }
+
+    auto* buffer = &threads[(size_t) index];
+    buffer->isMessageThread = juce::MessageManager::existsAndIsCurrentThread();
+
+    threadClaim = { serial, buffer };
+    return buffer;
+}
+
+void Session::run()
+{
+    while( ! threadShouldExit() )
+    {
+        drain();
+        wait(100);
+    }
+}
+
+void Session::drain()
+{
+    auto ticksPerMicrosecond = (double) juce::Time::getHighResolutionTicksPerSecond() / 1.0e6;
+    auto claimed = juce::jmin(numThreads.load(std::memory_order_acquire), maxThreads);
+
+    for( int t = 0; t < claimed; ++t )
+    {
+        auto& buffer = threads[(size_t) t];
+        auto tid = t + 1;
+        auto read = buffer.readIndex.load(std::memory_order_relaxed);
+        auto write = buffer.writeIndex.load(std::memory_order_acquire);
+
+        //claimed but nothing pushed yet, isMessageThread isn't safe to read until the first event is
+        if( write == 0 )
+            continue;
+
+        if( ! buffer.isNamed )
+        {
+            *stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+                    << ",\"args\":{\"name\":\"" << (buffer.isMessageThread ? juce::String("message thread")
+                                                                           : "thread " + juce::String(tid)) << "\"}},\n";
+            buffer.isNamed = true;
+        }
+
+        for( ; read != write; ++read )
+        {
+            auto& event = buffer.events[read % eventsPerThread];
+            auto microseconds = (double) (event.ticks - startTicks) / ticksPerMicrosecond;
+
+            *stream << "{\"name\":\"" << event.name << "\",\"ph\":\"" << (event.isBegin ? "B" : "E")
+                    << "\",\"ts\":" << juce::String(microseconds, 3) << ",\"pid\":1,\"tid\":" << tid << "},\n";
+        }
+
+        buffer.readIndex.store(read, std::memory_order_release);
+    }
+
+    stream->flush();
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+Scope::Scope(const char* eventName) noexcept : name(eventName)
+{
+    if( activeSession.load(std::memory_order_relaxed) == nullptr )
+        return;
+
+    //count ourselves in before taking the session for real, so its destructor either
+    //sees us and waits, or has already cleared activeSession and we see null
+    openScopes.fetch_add(1);
+
+    if( auto* session = activeSession.load() )
+        buffer = session->getThreadBuffer();
+
+    if( buffer == nullptr )
+    {
+        openScopes.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+
+    buffer->push(name, true);
+}
+
+Scope::~Scope()
+{
+    if( buffer == nullptr )
+        return;
+
+    buffer->push(name, false);
+    openScopes.fetch_sub(1, std::memory_order_release);
+}
+
+}
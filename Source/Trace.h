@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    Trace.h
+    Optional timeline of what the audio and GUI threads were doing.
+
+    While a Session is alive and has a file to write to (SIMPLEEQ_TRACE in the
+    environment, or setOutputFile), every Scope records a begin and an end
+    event into a ring owned by the thread it ran on. Recording is lock-free
+    and never allocates, a background thread drains the rings into a Chrome
+    trace (open it in chrome://tracing or ui.perfetto.dev).
+
+    With no file the scopes cost one atomic load.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+namespace Trace
+{
+    //overrides SIMPLEEQ_TRACE for sessions started after this, an empty file turns tracing off
+    void setOutputFile(const juce::File& file);
+
+    //held by everything that records, as a SharedResourcePointer.
+    //the first one in the process opens the file, the last one finishes it
+    struct Session : private juce::Thread
+    {
+        Session();
+        ~Session() override;
+
+        bool isRecording() const { return threads != nullptr; }
+
+        struct ThreadBuffer;
+
+    private:
+        juce::File file;
+        std::unique_ptr<juce::FileOutputStream> stream;
+        std::unique_ptr<ThreadBuffer[]> threads;
+        std::atomic<int> numThreads { 0 };
+        juce::int64 startTicks { 0 };
+        int serial { 0 };
+
+        friend struct Scope;
+        ThreadBuffer* getThreadBuffer() noexcept;
+
+        void run() override;
+        void drain();
+
+        JUCE_DECLARE_NON_COPYABLE(Session)
+    };
+
+    //begin on construction, end when it goes out of scope.
+    //name has to outlive the session, a string literal.
+    //a session waits for the open scopes before it frees its rings, so the last
+    //SharedResourcePointer to it mustn't go away inside a Scope on the same thread
+    struct Scope
+    {
+        explicit Scope(const char* name) noexcept;
+        ~Scope();
+
+    private:
+        Session::ThreadBuffer* buffer { nullptr };
+        const char* name;
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+}
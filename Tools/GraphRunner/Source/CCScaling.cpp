@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    CCScaling.cpp
+    What dense MIDI CC streams cost one SimpleEq.
+
+  ==============================================================================
+*/
+
+#include "CCScaling.h"
+#include "GraphRunner.h"
+#include "../../../Source/PluginProcessor.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct EventResult
+{
+    double meanMicroseconds { 0 }, p99Microseconds { 0 };
+};
+
+static EventResult measure(const CCScaling::Options& options, FilterEngine engine, int eventsPerBlock)
+{
+    SimpleEqAudioProcessor processor;
+    processor.apvts.getParameter(Parameters::getID(Parameters::FilterEngineChoice))->setValueNotifyingHost(engine == SvfEngine ? 1.f : 0.f);
+
+    processor.setRateAndBufferSizeDetails(options.sampleRate, options.blockSize);
+    processor.prepareToPlay(options.sampleRate, options.blockSize);
+
+    juce::AudioBuffer<float> buffer(2, options.blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random(1);
+
+    //every continuous controller of the first set in turn (the defaults, 20 - 24) to a new value each time
+    auto fill = [&]
+    {
+        for( int channel = 0; channel < buffer.getNumChannels(); ++channel )
+        {
+            auto* samples = buffer.getWritePointer(channel);
+
+            for( int i = 0; i < options.blockSize; ++i )
+                samples[i] = random.nextFloat() - 0.5f;
+        }
+
+        midi.clear();
+
+        for( int e = 0; e < eventsPerBlock; ++e )
+        {
+            auto position = e * options.blockSize / eventsPerBlock;
+            midi.addEvent(juce::MidiMessage::controllerEvent(1, 20 + e % MidiCCMap::LowCutSlope, random.nextInt(128)), position);
+        }
+    };
+
+    for( int i = 0; i < 50; ++i )
+    {
+        fill();
+        processor.processBlock(buffer, midi);
+    }
+
+    std::vector<double> blockMicroseconds;
+    blockMicroseconds.reserve((size_t) options.numBlocks);
+
+    for( int i = 0; i < options.numBlocks; ++i )
+    {
+        fill();
+
+        auto start = juce::Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midi);
+        blockMicroseconds.push_back(1.0e6 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+    }
+
+    processor.releaseResources();
+
+    EventResult result;
+    result.meanMicroseconds = std::accumulate(blockMicroseconds.begin(), blockMicroseconds.end(), 0.0) / juce::jmax(1, options.numBlocks);
+    result.p99Microseconds = percentile(blockMicroseconds, 0.99);
+    return result;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+int CCScaling::run(const Options& options)
+{
+    auto budgetMicroseconds = 1.0e6 * options.blockSize / options.sampleRate;
+
+    std::cout << "cc scaling: block " << options.blockSize << " @ " << options.sampleRate << " Hz (budget "
+              << budgetMicroseconds << " us), " << options.numBlocks << " blocks" << std::endl;
+
+    std::cout << " events    biquad us   p99 us  us/event       svf us   p99 us  us/event" << std::endl;
+
+    std::vector<int> eventCounts { 0 };
+
+    for( int events = 1; events <= options.blockSize; events *= 2 )
+        eventCounts.push_back(events);
+
+    EventResult biquadBaseline, svfBaseline;
+
+    for( auto events : eventCounts )
+    {
+        auto biquad = measure(options, BiquadEngine, events);
+        auto svf = measure(options, SvfEngine, events);
+
+        if( events == 0 )
+        {
+            biquadBaseline = biquad;
+            svfBaseline = svf;
+        }
+
+        auto perEvent = [events](const EventResult& result, const EventResult& baseline)
+        {
+            return events > 0 ? (result.meanMicroseconds - baseline.meanMicroseconds) / events : 0.0;
+        };
+
+        std::cout << juce::String(events).paddedLeft(' ', 7)
+                  << juce::String(biquad.meanMicroseconds, 1).paddedLeft(' ', 13)
+                  << juce::String(biquad.p99Microseconds, 1).paddedLeft(' ', 9)
+                  << juce::String(perEvent(biquad, biquadBaseline), 2).paddedLeft(' ', 10)
+                  << juce::String(svf.meanMicroseconds, 1).paddedLeft(' ', 13)
+                  << juce::String(svf.p99Microseconds, 1).paddedLeft(' ', 9)
+                  << juce::String(perEvent(svf, svfBaseline), 2).paddedLeft(' ', 10) << std::endl;
+    }
+
+    return 0;
+}
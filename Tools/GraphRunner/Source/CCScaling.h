@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    CCScaling.h
+    What dense MIDI CC streams cost one SimpleEq.
+
+    One stereo instance fed noise, with 0, 1, 2, 4 ... mapped controller
+    events spread evenly over every block, on both engines. Reports the
+    block times and the cost of each event over a block without any, so a
+    CC lane that doubles its density should show up as a flat per-event
+    cost, not a growing one.
+
+    GraphRunner --cc-scaling [--blocks=B] [--block-size=S] [--sample-rate=R]
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct CCScaling
+{
+    struct Options
+    {
+        int numBlocks { 2000 };
+        int blockSize { 256 };
+        double sampleRate { 48000.0 };
+    };
+
+    //prints the report, returns the process exit code
+    static int run(const Options& options);
+};
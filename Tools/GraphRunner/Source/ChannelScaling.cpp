@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    ChannelScaling.cpp
+    How one SimpleEq on a wide bus scales with its channel workers.
+
+  ==============================================================================
+*/
+
+#include "ChannelScaling.h"
+#include "GraphRunner.h"
+#include "../../../Source/PluginProcessor.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct ScalingResult
+{
+    double meanMicroseconds { 0 }, p99Microseconds { 0 }, maxMicroseconds { 0 };
+    ChannelWorkers::Stats stats;
+};
+
+static ScalingResult measure(const ChannelScaling::Options& options, int numWorkers)
+{
+    SimpleEqAudioProcessor processor;
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::discreteChannels(options.numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::discreteChannels(options.numChannels));
+
+    auto hasLayout = processor.setBusesLayout(layout);
+    jassert(hasLayout);
+    juce::ignoreUnused(hasLayout);
+
+    //the steepest cuts, the most sections per channel
+    processor.apvts.getParameter(Parameters::getID(Parameters::LowCutSlope))->setValueNotifyingHost(1.f);
+    processor.apvts.getParameter(Parameters::getID(Parameters::HighCutSlope))->setValueNotifyingHost(1.f);
+
+    processor.setChannelWorkers(numWorkers);
+    processor.setRateAndBufferSizeDetails(options.sampleRate, options.blockSize);
+    processor.prepareToPlay(options.sampleRate, options.blockSize);
+
+    juce::AudioBuffer<float> buffer(options.numChannels, options.blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random(1);
+
+    auto fill = [&]
+    {
+        for( int channel = 0; channel < options.numChannels; ++channel )
+        {
+            auto* samples = buffer.getWritePointer(channel);
+
+            for( int i = 0; i < options.blockSize; ++i )
+                samples[i] = random.nextFloat() - 0.5f;
+        }
+    };
+
+    //let the workers start spinning and the caches settle
+    for( int i = 0; i < 50; ++i )
+    {
+        fill();
+        processor.processBlock(buffer, midi);
+    }
+
+    auto before = processor.getChannelWorkerStats();
+    std::vector<double> blockMicroseconds;
+    blockMicroseconds.reserve((size_t) options.numBlocks);
+
+    for( int i = 0; i < options.numBlocks; ++i )
+    {
+        fill();
+
+        auto start = juce::Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midi);
+        blockMicroseconds.push_back(1.0e6 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+    }
+
+    auto after = processor.getChannelWorkerStats();
+
+    ScalingResult result;
+    result.meanMicroseconds = std::accumulate(blockMicroseconds.begin(), blockMicroseconds.end(), 0.0) / juce::jmax(1, options.numBlocks);
+    result.p99Microseconds = percentile(blockMicroseconds, 0.99);
+    result.maxMicroseconds = percentile(blockMicroseconds, 1.0);
+    result.stats = { after.parallelBlocks - before.parallelBlocks, after.missedDeadlines - before.missedDeadlines,
+                     after.stolenChannels - before.stolenChannels, after.fallbacks - before.fallbacks };
+
+    processor.releaseResources();
+    return result;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+int ChannelScaling::run(const Options& options)
+{
+    if( options.numChannels < ChannelWorkers::minChannels )
+    {
+        std::cerr << "the workers only run on buses of " << ChannelWorkers::minChannels << " channels or more" << std::endl;
+        return 1;
+    }
+
+    auto maxWorkers = options.maxWorkers > 0 ? options.maxWorkers : juce::jmax(1, juce::SystemStats::getNumCpus() - 1);
+    maxWorkers = juce::jmin(maxWorkers, options.numChannels / ChannelWorkers::minChannelsPerGroup - 1);
+
+    auto budgetMicroseconds = 1.0e6 * options.blockSize / options.sampleRate;
+
+    std::cout << "channel scaling: " << options.numChannels << " channels, block " << options.blockSize << " @ "
+              << options.sampleRate << " Hz (budget " << budgetMicroseconds << " us), " << options.numBlocks
+              << " blocks, " << juce::SystemStats::getNumCpus() << " cpus" << std::endl;
+
+    std::cout << "workers   mean us    p99 us    max us   speedup  parallel  missed  stolen  fallbacks" << std::endl;
+
+    double serialMean = 0;
+
+    //doubling, and the maximum itself if it isn't a power of two
+    std::vector<int> workerCounts { 0 };
+
+    for( int w = 1; w < maxWorkers; w *= 2 )
+        workerCounts.push_back(w);
+
+    workerCounts.push_back(maxWorkers);
+
+    for( auto numWorkers : workerCounts )
+    {
+        auto result = measure(options, numWorkers);
+
+        if( numWorkers == 0 )
+            serialMean = result.meanMicroseconds;
+
+        std::cout << juce::String(numWorkers).paddedLeft(' ', 7)
+                  << juce::String(result.meanMicroseconds, 1).paddedLeft(' ', 10)
+                  << juce::String(result.p99Microseconds, 1).paddedLeft(' ', 10)
+                  << juce::String(result.maxMicroseconds, 1).paddedLeft(' ', 10)
+                  << juce::String(serialMean / juce::jmax(1.0e-9, result.meanMicroseconds), 2).paddedLeft(' ', 9) << "x"
+                  << juce::String(result.stats.parallelBlocks).paddedLeft(' ', 10)
+                  << juce::String(result.stats.missedDeadlines).paddedLeft(' ', 8)
+                  << juce::String(result.stats.stolenChannels).paddedLeft(' ', 8)
+                  << juce::String(result.stats.fallbacks).paddedLeft(' ', 11) << std::endl;
+    }
+
+    return 0;
+}
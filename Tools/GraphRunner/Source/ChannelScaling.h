@@ -0,0 +1,36 @@
+/*
+  ==============================================================================
+
+    ChannelScaling.h
+    How one SimpleEq on a wide bus scales with its channel workers.
+
+    A single instance on a discrete bus (64 channels unless told otherwise),
+    both cuts at 96 dB/Oct, run on the audio thread alone and then with more
+    and more ChannelWorkers. Reports the block times, the speedup over the
+    serial run and how often the workers missed their deadline.
+
+    GraphRunner --channel-scaling [--channels=N] [--max-workers=W]
+                                  [--blocks=B] [--block-size=S] [--sample-rate=R]
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct ChannelScaling
+{
+    struct Options
+    {
+        int numChannels { 64 };
+        int maxWorkers { 0 };       //0 goes up to one per core but ours
+        int numBlocks { 2000 };
+        int blockSize { 128 };
+        double sampleRate { 48000.0 };
+    };
+
+    //prints the report, returns the process exit code
+    static int run(const Options& options);
+};
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    EditorTiming.cpp
+    How long a SimpleEq editor takes to open.
+
+  ==============================================================================
+*/
+
+#include "EditorTiming.h"
+#include "GraphRunner.h"
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/PluginEditor.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+static double millisecondsSince(juce::int64 startTicks)
+{
+    return 1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+}
+
+static void printRow(const juce::String& name, const std::vector<double>& milliseconds)
+{
+    auto mean = std::accumulate(milliseconds.begin(), milliseconds.end(), 0.0) / juce::jmax((size_t) 1, milliseconds.size());
+
+    std::cout << name.paddedRight(' ', 22)
+              << juce::String(mean, 3).paddedLeft(' ', 9)
+              << juce::String(percentile(milliseconds, 0.99), 3).paddedLeft(' ', 9)
+              << juce::String(percentile(milliseconds, 1.0), 3).paddedLeft(' ', 9) << std::endl;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+int EditorTiming::run(const Options& options)
+{
+    if( options.numEditors < 1 )
+    {
+        std::cerr << "--editors needs at least one" << std::endl;
+        return 1;
+    }
+
+    //prepared, so every editor has a real curve to draw
+    std::vector<std::unique_ptr<SimpleEqAudioProcessor>> processors;
+
+    for( int i = 0; i < options.numEditors; ++i )
+    {
+        processors.push_back(std::make_unique<SimpleEqAudioProcessor>());
+        processors.back()->setRateAndBufferSizeDetails(options.sampleRate, options.blockSize);
+        processors.back()->prepareToPlay(options.sampleRate, options.blockSize);
+    }
+
+    //there's no message loop, its ticks are called by hand. held for the whole run,
+    //like a host that has other editors open
+    juce::SharedResourcePointer<SharedRepaintTimer> repaintTimer;
+
+    std::vector<double> construct, firstFrame, toFirstFrame, deferred, toFullFrame;
+    auto totalStart = juce::Time::getHighResolutionTicks();
+
+    for( auto& processor : processors )
+    {
+        auto start = juce::Time::getHighResolutionTicks();
+        std::unique_ptr<juce::AudioProcessorEditor> editor { processor->createEditorAndMakeActive() };
+        construct.push_back(millisecondsSince(start));
+
+        auto frameStart = juce::Time::getHighResolutionTicks();
+        editor->createComponentSnapshot(editor->getLocalBounds());
+        firstFrame.push_back(millisecondsSince(frameStart));
+        toFirstFrame.push_back(millisecondsSince(start));
+
+        auto tickStart = juce::Time::getHighResolutionTicks();
+        repaintTimer->timerCallback();
+        deferred.push_back(millisecondsSince(tickStart));
+
+        editor->createComponentSnapshot(editor->getLocalBounds());
+        toFullFrame.push_back(millisecondsSince(start));
+    }
+
+    auto totalMilliseconds = millisecondsSince(totalStart);
+
+    std::cout << "editor open: " << options.numEditors << " editors, opened and closed one after another" << std::endl;
+    std::cout << juce::String().paddedRight(' ', 22) << "  mean ms   p99 ms   max ms" << std::endl;
+
+    printRow("constructor", construct);
+    printRow("first frame", firstFrame);
+    printRow("open to first frame", toFirstFrame);
+    printRow("first tick", deferred);
+    printRow("open to full frame", toFullFrame);
+
+    std::cout << juce::String("all editors").paddedRight(' ', 22) << juce::String(totalMilliseconds, 3).paddedLeft(' ', 9) << std::endl;
+
+    for( auto& processor : processors )
+        processor->releaseResources();
+
+    return 0;
+}
@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+    EditorTiming.h
+    How long a SimpleEq editor takes to open.
+
+    Flips through a row of prepared instances the way you would through
+    channel strips, opening and closing each one's editor in turn. Times the
+    constructor, the first frame (rendered into an image, there's no window),
+    the work put off to the first repaint timer tick and the frame after it.
+
+    GraphRunner --editor-open [--editors=N]
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct EditorTiming
+{
+    struct Options
+    {
+        int numEditors { 100 };
+        int blockSize { 256 };
+        double sampleRate { 48000.0 };
+    };
+
+    //prints the report, returns the process exit code
+    static int run(const Options& options);
+};
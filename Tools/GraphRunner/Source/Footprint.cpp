@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    Footprint.cpp
+    Resident memory of a session full of SimpleEqs.
+
+  ==============================================================================
+*/
+
+#include "Footprint.h"
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/PluginEditor.h"
+#include <unistd.h>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//resident pages are the second field
+static double getResidentKilobytes()
+{
+    auto fields = juce::StringArray::fromTokens(juce::File("/proc/self/statm").loadFileAsString(), false);
+
+    if( fields.size() < 2 )
+        return 0.0;
+
+    return fields[1].getLargeIntValue() * (double) sysconf(_SC_PAGESIZE) / 1024.0;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+int Footprint::run(const Options& options)
+{
+    if( options.numInstances < 2 )
+    {
+        std::cerr << "--instances needs at least two" << std::endl;
+        return 1;
+    }
+
+    auto before = getResidentKilobytes();
+
+    if( before <= 0.0 )
+    {
+        std::cerr << "can't read /proc/self/statm" << std::endl;
+        return 1;
+    }
+
+    //a block through each, so the pages they'd touch when playing are in
+    std::vector<std::unique_ptr<SimpleEqAudioProcessor>> processors;
+    juce::AudioBuffer<float> buffer(2, options.blockSize);
+    juce::MidiBuffer midi;
+
+    for( int i = 0; i < options.numInstances; ++i )
+    {
+        auto& processor = *processors.emplace_back(std::make_unique<SimpleEqAudioProcessor>());
+        processor.setRateAndBufferSizeDetails(options.sampleRate, options.blockSize);
+        processor.prepareToPlay(options.sampleRate, options.blockSize);
+
+        buffer.clear();
+        buffer.setSample(0, 0, 1.f);
+        processor.processBlock(buffer, midi);
+    }
+
+    auto withProcessors = getResidentKilobytes();
+
+    //all open at once, each drawn and finished off the way the first repaint tick would
+    juce::SharedResourcePointer<SharedRepaintTimer> repaintTimer;
+    std::vector<std::unique_ptr<juce::AudioProcessorEditor>> editors;
+    double withFirstEditor = 0.0;
+
+    for( auto& processor : processors )
+    {
+        auto& editor = *editors.emplace_back(processor->createEditorAndMakeActive());
+        repaintTimer->timerCallback();
+        editor.createComponentSnapshot(editor.getLocalBounds());
+
+        if( editors.size() == 1 )
+            withFirstEditor = getResidentKilobytes();
+    }
+
+    auto withEditors = getResidentKilobytes();
+    auto numInstances = (double) options.numInstances;
+
+    std::cout << "footprint: " << options.numInstances << " stereo instances, block " << options.blockSize
+              << " @ " << options.sampleRate << " Hz" << std::endl;
+
+    std::cout << "resident before      " << juce::String(before / 1024.0, 1) << " MB" << std::endl;
+    std::cout << "per instance         " << juce::String((withProcessors - before) / numInstances, 1) << " kB" << std::endl;
+    std::cout << "first editor         " << juce::String(withFirstEditor - withProcessors, 1) << " kB (with the shared resources)" << std::endl;
+    std::cout << "per further editor   " << juce::String((withEditors - withFirstEditor) / (numInstances - 1.0), 1) << " kB" << std::endl;
+    std::cout << "resident after       " << juce::String(withEditors / 1024.0, 1) << " MB" << std::endl;
+
+    editors.clear();
+
+    for( auto& processor : processors )
+        processor->releaseResources();
+
+    return 0;
+}
@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    Footprint.h
+    Resident memory of a session full of SimpleEqs.
+
+    Creates N prepared stereo instances, then opens an editor on every one
+    of them and keeps them all open, reading the process's resident set
+    (/proc/self/statm) before and after each step. The first editor is
+    reported on its own: it brings the process-wide GUI resources with it,
+    every editor after it only adds its own components.
+
+    GraphRunner --footprint [--instances=N]
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct Footprint
+{
+    struct Options
+    {
+        int numInstances { 200 };
+        int blockSize { 256 };
+        double sampleRate { 48000.0 };
+    };
+
+    //prints the report, returns the process exit code
+    static int run(const Options& options);
+};
@@ -0,0 +1,400 @@
+/*
+  ==============================================================================
+
+    GraphRunner.cpp
+    Headless runner for graphs of SimpleEq instances.
+
+  ==============================================================================
+*/
+
+#include "GraphRunner.h"
+#include "../../../Source/PluginProcessor.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+GraphNode& FilterGraph::addNode(int uid, const juce::String& name, bool isSimpleEq)
+{
+    auto node = std::make_unique<GraphNode>();
+    node->uid = uid;
+    node->name = name;
+    node->random.setSeed((juce::int64) uid);
+
+    if( isSimpleEq )
+        node->processor = std::make_unique<SimpleEqAudioProcessor>();
+
+    nodes.push_back(std::move(node));
+    return *nodes.back();
+}
+
+void FilterGraph::connect(GraphNode& source, int sourceChannel, GraphNode& dest, int destChannel)
+{
+    //everything here is stereo, the host's midi connections (channel 0x1000) are dropped too
+    if( ! juce::isPositiveAndBelow(sourceChannel, 2) || ! juce::isPositiveAndBelow(destChannel, 2) )
+        return;
+
+    dest.inputs.push_back({ &source, sourceChannel, destChannel });
+}
+
+juce::Result FilterGraph::finishConnections()
+{
+    for( auto& node : nodes )
+    {
+        std::set<GraphNode*> sources;
+
+        for( auto& input : node->inputs )
+            sources.insert(input.source);
+
+        node->numSourceNodes = (int) sources.size();
+
+        for( auto* source : sources )
+            source->dependents.push_back(node.get());
+    }
+
+    //the scheduler would wait forever on a feedback loop, catch it here
+    std::map<GraphNode*, int> pending;
+    std::vector<GraphNode*> ready;
+
+    for( auto& node : nodes )
+    {
+        pending[node.get()] = node->numSourceNodes;
+
+        if( node->numSourceNodes == 0 )
+            ready.push_back(node.get());
+    }
+
+    size_t visited = 0;
+
+    while( ! ready.empty() )
+    {
+        auto* node = ready.back();
+        ready.pop_back();
+        ++visited;
+
+        for( auto* dependent : node->dependents )
+        {
+            if( --pending[dependent] == 0 )
+                ready.push_back(dependent);
+        }
+    }
+
+    if( visited != nodes.size() )
+        return juce::Result::fail("the graph contains a feedback loop");
+
+    return juce::Result::ok();
+}
+
+juce::Result FilterGraph::loadFromFile(const juce::File& file)
+{
+    auto xml = juce::parseXML(file);
+
+    if( xml == nullptr || ! xml->hasTagName("FILTERGRAPH") )
+        return juce::Result::fail("not a filtergraph: " + file.getFullPathName());
+
+    std::map<int, GraphNode*> byUid;
+
+    for( auto* filter : xml->getChildWithTagNameIterator("FILTER") )
+    {
+        auto* plugin = filter->getChildByName("PLUGIN");
+        auto name = plugin != nullptr ? plugin->getStringAttribute("name") : juce::String("Unknown");
+        auto& node = addNode(filter->getIntAttribute("uid"), name, name == "SimpleEq");
+
+        if( node.processor != nullptr )
+        {
+            if( auto* state = filter->getChildByName("STATE") )
+            {
+                juce::MemoryBlock data;
+
+                if( data.fromBase64Encoding(state->getAllSubText().trim()) && data.getSize() > 0 )
+                    node.processor->setStateInformation(data.getData(), (int) data.getSize());
+            }
+        }
+
+        byUid[node.uid] = &node;
+    }
+
+    for( auto* connection : xml->getChildWithTagNameIterator("CONNECTION") )
+    {
+        auto source = byUid.find(connection->getIntAttribute("srcFilter"));
+        auto dest = byUid.find(connection->getIntAttribute("dstFilter"));
+
+        if( source == byUid.end() || dest == byUid.end() )
+            return juce::Result::fail("connection to a missing filter");
+
+        connect(*source->second, connection->getIntAttribute("srcChannel"),
+                *dest->second, connection->getIntAttribute("dstChannel"));
+    }
+
+    return finishConnections();
+}
+
+void FilterGraph::generate(int numInstances, bool serial)
+{
+    auto& input = addNode(1, "Audio Input", false);
+    auto& output = addNode(2, "Audio Output", false);
+    auto* previous = &input;
+
+    for( int i = 0; i < numInstances; ++i )
+    {
+        auto& eq = addNode(10 + i, "SimpleEq " + juce::String(i + 1), true);
+
+        //spread the instances out so they don't all design the same filters
+        if( auto* simpleEq = dynamic_cast<SimpleEqAudioProcessor*>(eq.processor.get()) )
+        {
+            auto set = [&](Parameters::Index index, float normalisedValue)
+            {
+                simpleEq->apvts.getParameter(Parameters::getID(index))->setValueNotifyingHost(normalisedValue);
+            };
+
+            set(Parameters::PeakFreq, eq.random.nextFloat());
+            set(Parameters::PeakGain, eq.random.nextFloat());
+            set(Parameters::LowCutFreq, eq.random.nextFloat() * 0.3f);
+            set(Parameters::LowCutSlope, eq.random.nextFloat());
+            set(Parameters::HighCutFreq, 0.7f + eq.random.nextFloat() * 0.3f);
+            set(Parameters::HighCutSlope, eq.random.nextFloat());
+            set(Parameters::LowCutFamily, eq.random.nextFloat());
+            set(Parameters::HighCutFamily, eq.random.nextFloat());
+        }
+
+        for( int channel = 0; channel < 2; ++channel )
+        {
+            connect(*previous, channel, eq, channel);
+
+            if( ! serial )
+                connect(eq, channel, output, channel);
+        }
+
+        if( serial )
+            previous = &eq;
+    }
+
+    if( serial )
+    {
+        for( int channel = 0; channel < 2; ++channel )
+            connect(*previous, channel, output, channel);
+    }
+
+    auto result = finishConnections();
+    jassertquiet(result.wasOk());
+}
+
+void FilterGraph::prepare(double sampleRate, int blockSize)
+{
+    for( auto& node : nodes )
+    {
+        node->buffer.setSize(2, blockSize);
+
+        if( node->processor != nullptr )
+        {
+            node->processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+            node->processor->prepareToPlay(sampleRate, blockSize);
+        }
+    }
+}
+
+void FilterGraph::setParameter(const juce::String& parameterID, float normalisedValue)
+{
+    for( auto& node : nodes )
+    {
+        if( auto* simpleEq = dynamic_cast<SimpleEqAudioProcessor*>(node->processor.get()) )
+        {
+            if( auto* param = simpleEq->apvts.getParameter(parameterID) )
+                param->setValueNotifyingHost(normalisedValue);
+        }
+    }
+}
+
+void FilterGraph::enableAutomation()
+{
+    for( auto& node : nodes )
+    {
+        if( auto* simpleEq = dynamic_cast<SimpleEqAudioProcessor*>(node->processor.get()) )
+        {
+            for( auto index : { Parameters::PeakFreq, Parameters::PeakGain, Parameters::PeakQuality,
+                                Parameters::LowCutFreq, Parameters::HighCutFreq } )
+                node->automatedParameters.push_back(simpleEq->apvts.getParameter(Parameters::getID(index)));
+        }
+    }
+}
+
+int FilterGraph::getNumInstances() const
+{
+    int numInstances = 0;
+
+    for( auto& node : nodes )
+    {
+        if( node->processor != nullptr )
+            ++numInstances;
+    }
+
+    return numInstances;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+GraphScheduler::GraphScheduler(FilterGraph& g, int numThreads) : graph(g)
+{
+    for( int i = 0; i < juce::jmax(1, numThreads); ++i )
+        workers.push_back(std::make_unique<Worker>());
+
+    //worker 0 is whoever calls processBlock
+    for( size_t i = 1; i < workers.size(); ++i )
+        workers[i]->thread = std::thread([this, i] { workerLoop((int) i); });
+}
+
+GraphScheduler::~GraphScheduler()
+{
+    shouldExit.store(true);
+
+    for( auto& worker : workers )
+    {
+        if( worker->thread.joinable() )
+            worker->thread.join();
+    }
+}
+
+void GraphScheduler::push(int worker, GraphNode* node)
+{
+    auto& w = *workers[(size_t) worker];
+    std::lock_guard<std::mutex> sl(w.lock);
+    w.queue.push_back(node);
+}
+
+GraphNode* GraphScheduler::pop(int worker)
+{
+    //own work comes off the back, it's the most recently readied and still in cache
+    auto& w = *workers[(size_t) worker];
+    std::lock_guard<std::mutex> sl(w.lock);
+
+    if( w.queue.empty() )
+        return nullptr;
+
+    auto* node = w.queue.back();
+    w.queue.pop_back();
+    return node;
+}
+
+GraphNode* GraphScheduler::steal(int thief)
+{
+    auto numWorkers = (int) workers.size();
+
+    for( int offset = 1; offset < numWorkers; ++offset )
+    {
+        auto& victim = *workers[(size_t) ((thief + offset) % numWorkers)];
+        std::lock_guard<std::mutex> sl(victim.lock);
+
+        if( ! victim.queue.empty() )
+        {
+            auto* node = victim.queue.front();
+            victim.queue.pop_front();
+            ++workers[(size_t) thief]->steals;
+            return node;
+        }
+    }
+
+    return nullptr;
+}
+
+bool GraphScheduler::runOne(int worker)
+{
+    auto* node = pop(worker);
+
+    if( node == nullptr )
+        node = steal(worker);
+
+    if( node == nullptr )
+        return false;
+
+    run(*node, worker);
+    return true;
+}
+
+void GraphScheduler::run(GraphNode& node, int worker)
+{
+    auto start = juce::Time::getHighResolutionTicks();
+    auto numSamples = node.buffer.getNumSamples();
+
+    if( node.isSource() )
+    {
+        for( int channel = 0; channel < node.buffer.getNumChannels(); ++channel )
+        {
+            auto* samples = node.buffer.getWritePointer(channel);
+
+            for( int i = 0; i < numSamples; ++i )
+                samples[i] = (node.random.nextFloat() * 2.f - 1.f) * 0.25f;
+        }
+    }
+    else
+    {
+        node.buffer.clear();
+
+        for( auto& input : node.inputs )
+            node.buffer.addFrom(input.destChannel, 0, input.source->buffer, input.sourceChannel, 0, numSamples);
+    }
+
+    //a slow sweep per parameter, every block lands on a new value
+    for( size_t p = 0; p < node.automatedParameters.size(); ++p )
+    {
+        auto value = 0.5 + 0.45 * std::sin(node.automationPhase + (double) p);
+        node.automatedParameters[p]->setValueNotifyingHost((float) value);
+    }
+
+    node.automationPhase += 0.05;
+
+    if( node.processor != nullptr )
+        node.processor->processBlock(node.buffer, node.midi);
+
+    auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+    node.totalSeconds += seconds;
+    node.maxSeconds = juce::jmax(node.maxSeconds, seconds);
+    node.blockSeconds.push_back(seconds);
+    workers[(size_t) worker]->busySeconds += seconds;
+
+    for( auto* dependent : node.dependents )
+    {
+        if( dependent->pendingSources.fetch_sub(1, std::memory_order_acq_rel) == 1 )
+            push(worker, dependent);
+    }
+
+    remaining.fetch_sub(1, std::memory_order_release);
+}
+
+void GraphScheduler::workerLoop(int worker)
+{
+    while( ! shouldExit.load(std::memory_order_relaxed) )
+    {
+        if( ! runOne(worker) )
+            std::this_thread::yield();
+    }
+}
+
+void GraphScheduler::processBlock()
+{
+    remaining.store((int) graph.nodes.size(), std::memory_order_relaxed);
+
+    for( auto& node : graph.nodes )
+        node->pendingSources.store(node->numSourceNodes, std::memory_order_relaxed);
+
+    //hand the sources out round robin, everything else gets readied by its inputs
+    int next = 0;
+
+    for( auto& node : graph.nodes )
+    {
+        if( node->numSourceNodes == 0 )
+            push(next++ % getNumWorkers(), node.get());
+    }
+
+    while( remaining.load(std::memory_order_acquire) > 0 )
+    {
+        if( ! runOne(0) )
+            std::this_thread::yield();
+    }
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+double percentile(std::vector<double> values, double fraction)
+{
+    if( values.empty() )
+        return 0.0;
+
+    std::sort(values.begin(), values.end());
+    auto index = (size_t) juce::jlimit(0.0, (double) values.size() - 1.0, std::ceil(fraction * (double) values.size()) - 1.0);
+    return values[index];
+}
@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    GraphRunner.h
+    Headless runner for graphs of SimpleEq instances.
+
+    Loads an AudioPluginHost .filtergraph (or generates one) and processes it
+    block by block on a work-stealing thread pool, a node becomes runnable as
+    soon as every node feeding it has finished the current block.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <deque>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct GraphNode
+{
+    int uid { 0 };
+    juce::String name;
+
+    //SimpleEq instances have a processor, everything else is a noise source or a mixer
+    std::unique_ptr<juce::AudioProcessor> processor;
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+    juce::Random random;
+
+    struct Input
+    {
+        GraphNode* source;
+        int sourceChannel, destChannel;
+    };
+
+    std::vector<Input> inputs;
+    std::vector<GraphNode*> dependents;
+
+    //parameters swept a little every block to simulate heavy automation
+    std::vector<juce::RangedAudioParameter*> automatedParameters;
+    double automationPhase { 0 };
+    int numSourceNodes { 0 };
+    std::atomic<int> pendingSources { 0 };
+
+    //timing, only touched by whichever worker runs the node
+    double totalSeconds { 0 }, maxSeconds { 0 };
+    std::vector<double> blockSeconds;
+
+    bool isSource() const { return inputs.empty(); }
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct FilterGraph
+{
+    //SimpleEq nodes are created in-process, unknown plugins stand in as noise sources / mixers
+    juce::Result loadFromFile(const juce::File& file);
+
+    //noise source -> numInstances SimpleEqs -> output, either side by side or one after another
+    void generate(int numInstances, bool serial);
+
+    void prepare(double sampleRate, int blockSize);
+
+    //set a parameter on every SimpleEq, value normalised 0-1
+    void setParameter(const juce::String& parameterID, float normalisedValue);
+
+    //keep the frequencies and gains of every SimpleEq moving from block to block
+    void enableAutomation();
+
+    int getNumInstances() const;
+
+    std::vector<std::unique_ptr<GraphNode>> nodes;
+
+private:
+    GraphNode& addNode(int uid, const juce::String& name, bool isSimpleEq);
+    void connect(GraphNode& source, int sourceChannel, GraphNode& dest, int destChannel);
+    juce::Result finishConnections();
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct GraphScheduler
+{
+    GraphScheduler(FilterGraph& graph, int numThreads);
+    ~GraphScheduler();
+
+    //runs one block of the whole graph, the calling thread works too
+    void processBlock();
+
+    int getNumWorkers() const { return (int) workers.size(); }
+    double getBusySeconds(int worker) const { return workers[(size_t) worker]->busySeconds; }
+    int getNumSteals(int worker) const { return workers[(size_t) worker]->steals; }
+    void resetStats(int worker) { workers[(size_t) worker]->busySeconds = 0; workers[(size_t) worker]->steals = 0; }
+
+private:
+    struct Worker
+    {
+        std::mutex lock;
+        std::deque<GraphNode*> queue;
+        std::thread thread;
+        double busySeconds { 0 };
+        int steals { 0 };
+    };
+
+    FilterGraph& graph;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<int> remaining { 0 };
+    std::atomic<bool> shouldExit { false };
+
+    void push(int worker, GraphNode* node);
+    GraphNode* pop(int worker);
+    GraphNode* steal(int thief);
+    bool runOne(int worker);
+    void run(GraphNode& node, int worker);
+    void workerLoop(int worker);
+
+    JUCE_DECLARE_NON_COPYABLE(GraphScheduler)
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//the value below which fraction of them fall, 1.0 is the max
+double percentile(std::vector<double> values, double fraction);
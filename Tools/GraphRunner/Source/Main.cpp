@@ -0,0 +1,511 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    GraphRunner: process a graph of SimpleEq instances outside a DAW.
+
+    GraphRunner [file.filtergraph] [--generate=N] [--serial] [--threads=T]
+                [--blocks=B] [--block-size=S] [--sample-rate=R]
+                [--engine=biquad|svf] [--kernel=generic|avx2|avx512] [--automate]
+                [--offline] [--trace=file.json]
+    GraphRunner --verify [--sample-rate=R] [--record=AccuracyGateResults.h]
+    GraphRunner --stress [--blocks=B] [--max-block-size=S] [--seed=N] [--params-per-block=P]
+                         [--budget-max-us=U] [--budget-p9999-us=U]
+    GraphRunner --channel-scaling [--channels=N] [--max-workers=W]
+                                  [--blocks=B] [--block-size=S] [--sample-rate=R]
+    GraphRunner --cc-scaling [--blocks=B] [--block-size=S] [--sample-rate=R]
+    GraphRunner --editor-open [--editors=N]
+    GraphRunner --footprint [--instances=N]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "GraphRunner.h"
+#include "StressTest.h"
+#include "ChannelScaling.h"
+#include "CCScaling.h"
+#include "EditorTiming.h"
+#include "Footprint.h"
+#include "../../../Source/AccuracyGate.h"
+#include "../../../Source/FilterKernels.h"
+#include "../../../Source/Parameters.h"
+#include "../../../Source/Trace.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//hardware cache counters over the measured blocks. opened before the workers start so
+//they inherit them, reading one back gives the total over every thread.
+//needs perf_event_paranoid to let us count our own user space (2 or lower)
+struct CacheCounters
+{
+    enum Counter
+    {
+        References,
+        Misses,
+        L1dReadMisses,
+        NumCounters
+    };
+
+    CacheCounters()
+    {
+        fds[References] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
+        fds[Misses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        fds[L1dReadMisses] = open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                                                      | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                                      | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    }
+
+    ~CacheCounters()
+    {
+        for( auto fd : fds )
+            if( fd >= 0 )
+                close(fd);
+    }
+
+    bool isAvailable(Counter counter) const { return fds[counter] >= 0; }
+
+    void start()
+    {
+        for( auto fd : fds )
+        {
+            if( fd >= 0 )
+            {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    }
+
+    void stop()
+    {
+        for( auto fd : fds )
+            if( fd >= 0 )
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    juce::uint64 read(Counter counter) const
+    {
+        juce::uint64 count = 0;
+
+        if( fds[counter] < 0 || ::read(fds[counter], &count, sizeof(count)) != (ssize_t) sizeof(count) )
+            return 0;
+
+        return count;
+    }
+
+private:
+    std::array<int, NumCounters> fds;
+
+    static int open(juce::uint32 type, juce::uint64 config)
+    {
+        perf_event_attr attributes {};
+        attributes.size = sizeof(attributes);
+        attributes.type = type;
+        attributes.config = config;
+        attributes.disabled = 1;
+        attributes.inherit = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        return (int) syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+    }
+};
+
+static int getIntOption(const juce::ArgumentList& args, const juce::String& option, int defaultValue)
+{
+    auto value = args.getValueForOption(option);
+    return value.isNotEmpty() ? value.getIntValue() : defaultValue;
+}
+
+//every kernel this cpu can run over a stereo pair and a full run of lanes, every chain at 96 dB/Oct
+//on both cuts (8 + 1 + 8 sections) reading one shared set, so the dispatch choice can be checked
+//against the numbers. per channel-sample, a wider kernel only pays off once it has the lanes to fill
+static void benchmarkKernels(int blockSize, double sampleRate)
+{
+    constexpr int numRuns = 1000;
+    auto coefficients = juce::dsp::IIR::ArrayCoefficients<float>::makeLowPass(sampleRate, 1000.f);
+
+    CutCoefficients cut;
+    cut.numSections = FilterKernels::maxSections;
+    cut.sections.fill(coefficients);
+
+    ChainSections sections;
+    sections.setLowCut(cut);
+    sections.setPeak(coefficients);
+    sections.setHighCut(cut);
+
+    juce::Random random(1);
+    juce::AudioBuffer<float> buffer(FilterKernels::maxLanes, blockSize);
+
+    for( int c = 0; c < buffer.getNumChannels(); ++c )
+        for( int i = 0; i < blockSize; ++i )
+            buffer.setSample(c, i, random.nextFloat() - 0.5f);
+
+    for( auto numLanes : { 2, FilterKernels::maxLanes } )
+    {
+        std::cout << "kernel ns/sample, " << numLanes << " lanes";
+
+        for( int v = 0; v < FilterKernels::NumVariants; ++v )
+        {
+            auto variant = static_cast<FilterKernels::Variant>(v);
+
+            if( ! FilterKernels::isSupported(variant) )
+            {
+                std::cout << " " << FilterKernels::getName(variant) << " n/a";
+                continue;
+            }
+
+            auto kernel = FilterKernels::getKernel(variant);
+            std::vector<ChainState> states((size_t) numLanes);
+            std::array<FilterKernels::Lane, FilterKernels::maxLanes> lanes;
+
+            for( int l = 0; l < numLanes; ++l )
+                lanes[(size_t) l] = sections.makeLane(states[(size_t) l].states.data(), buffer.getWritePointer(l));
+
+            //best of a few rounds, the first warms the caches and the branch predictor
+            auto best = std::numeric_limits<double>::max();
+
+            for( int round = 0; round < 5; ++round )
+            {
+                auto start = juce::Time::getHighResolutionTicks();
+
+                for( int run = 0; run < numRuns; ++run )
+                    kernel(lanes.data(), numLanes, blockSize);
+
+                best = juce::jmin(best, juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+            }
+
+            std::cout << " " << FilterKernels::getName(variant) << " " << 1.0e9 * best / ((double) numRuns * blockSize * numLanes);
+        }
+
+        std::cout << std::endl;
+    }
+}
+
+//every processing path against the double precision reference, at one rate or the usual ones.
+//fails if a path would be switched off somewhere. --record writes the AccuracyGateResults.h the plugin reads
+static int verify(const juce::ArgumentList& args)
+{
+    std::vector<double> sampleRates { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    auto recordPath = args.getValueForOption("--record");
+
+    if( args.containsOption("--sample-rate") )
+    {
+        //the plugin uses the result at any rate, so only a run over all of them gets recorded
+        if( recordPath.isNotEmpty() )
+        {
+            std::cerr << "--record needs every sample rate, leave out --sample-rate" << std::endl;
+            return 1;
+        }
+
+        sampleRates = { (double) getIntOption(args, "--sample-rate", 48000) };
+    }
+
+    bool allPassed = true;
+    std::vector<std::array<AccuracyGate::Result, AccuracyGate::numPaths>> runs;
+
+    for( auto sampleRate : sampleRates )
+    {
+        runs.push_back(AccuracyGate::measure(sampleRate));
+        auto& results = runs.back();
+        std::cout << sampleRate << " Hz, " << results[0].numSettings << " settings" << std::endl;
+
+        for( int p = 0; p < AccuracyGate::numPaths; ++p )
+        {
+            auto path = static_cast<AccuracyGate::Path>(p);
+            auto& result = results[(size_t) p];
+
+            //a kernel this cpu can't run isn't a failure, it just isn't recorded as passed
+            if( ! result.isSupported )
+            {
+                std::cout << "  " << juce::String(AccuracyGate::getName(path)).paddedRight(' ', 16) << "n/a on this cpu" << std::endl;
+                continue;
+            }
+
+            std::cout << "  " << juce::String(AccuracyGate::getName(path)).paddedRight(' ', 16)
+                      << "magnitude " << result.magnitudeErrorDb << " dB, phase " << result.phaseErrorDegrees
+                      << " deg, output " << result.outputErrorDb << " dB, " << result.nanosecondsPerSample << " ns/sample  "
+                      << (AccuracyGate::getFallback(path) == path ? "fallback" : result.passed ? "pass" : "FAIL") << std::endl;
+
+            allPassed = allPassed && result.passed;
+        }
+    }
+
+    if( recordPath.isNotEmpty() )
+    {
+        auto file = juce::File::getCurrentWorkingDirectory().getChildFile(recordPath);
+
+        if( ! file.replaceWithText(AccuracyGate::createRecording(sampleRates, runs)) )
+        {
+            std::cerr << "couldn't write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        std::cout << "recorded to " << file.getFullPathName() << std::endl;
+    }
+
+    return allPassed ? 0 : 1;
+}
+
+int main (int argc, char* argv[])
+{
+    //apvts and the processors want a message manager around, it never gets run
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if( args.containsOption("--verify") )
+        return verify(args);
+
+    if( args.containsOption("--stress") )
+    {
+        StressTest::Options options;
+        options.numBlocks = getIntOption(args, "--blocks", options.numBlocks);
+        options.maxBlockSize = getIntOption(args, "--max-block-size", options.maxBlockSize);
+        options.parametersPerBlock = getIntOption(args, "--params-per-block", options.parametersPerBlock);
+        options.seed = getIntOption(args, "--seed", (int) options.seed);
+        options.maxBlockMicroseconds = args.getValueForOption("--budget-max-us").getDoubleValue();
+        options.p9999BlockMicroseconds = args.getValueForOption("--budget-p9999-us").getDoubleValue();
+
+        return StressTest::run(options);
+    }
+
+    if( args.containsOption("--channel-scaling") )
+    {
+        ChannelScaling::Options options;
+        options.numChannels = getIntOption(args, "--channels", options.numChannels);
+        options.maxWorkers = getIntOption(args, "--max-workers", options.maxWorkers);
+        options.numBlocks = getIntOption(args, "--blocks", options.numBlocks);
+        options.blockSize = getIntOption(args, "--block-size", options.blockSize);
+        options.sampleRate = (double) getIntOption(args, "--sample-rate", (int) options.sampleRate);
+
+        return ChannelScaling::run(options);
+    }
+
+    if( args.containsOption("--cc-scaling") )
+    {
+        CCScaling::Options options;
+        options.numBlocks = getIntOption(args, "--blocks", options.numBlocks);
+        options.blockSize = getIntOption(args, "--block-size", options.blockSize);
+        options.sampleRate = (double) getIntOption(args, "--sample-rate", (int) options.sampleRate);
+
+        return CCScaling::run(options);
+    }
+
+    if( args.containsOption("--editor-open") )
+    {
+        EditorTiming::Options options;
+        options.numEditors = getIntOption(args, "--editors", options.numEditors);
+
+        return EditorTiming::run(options);
+    }
+
+    if( args.containsOption("--footprint") )
+    {
+        Footprint::Options options;
+        options.numInstances = getIntOption(args, "--instances", options.numInstances);
+
+        return Footprint::run(options);
+    }
+
+    auto numThreads = getIntOption(args, "--threads", (int) std::thread::hardware_concurrency());
+    auto numBlocks = getIntOption(args, "--blocks", 2000);
+    auto blockSize = getIntOption(args, "--block-size", 256);
+    auto sampleRate = (double) getIntOption(args, "--sample-rate", 48000);
+
+    //the instances pick their kernel in prepareToPlay, this has to come first
+    auto kernelName = args.getValueForOption("--kernel");
+
+    if( kernelName.isNotEmpty() )
+    {
+        auto kernel = FilterKernels::findVariant(kernelName);
+
+        if( kernel == FilterKernels::NumVariants || ! FilterKernels::isSupported(kernel) )
+        {
+            std::cerr << "kernel " << kernelName << " isn't available on this machine" << std::endl;
+            return 1;
+        }
+
+        FilterKernels::forceVariant(kernel);
+    }
+
+    //has to be set before the first instance starts the session
+    auto tracePath = args.getValueForOption("--trace");
+
+    if( tracePath.isNotEmpty() )
+        Trace::setOutputFile(juce::File::getCurrentWorkingDirectory().getChildFile(tracePath));
+
+    FilterGraph graph;
+
+    if( args.containsOption("--generate") )
+    {
+        graph.generate(getIntOption(args, "--generate", 100), args.containsOption("--serial"));
+    }
+    else
+    {
+        juce::File file;
+
+        for( auto& arg : args.arguments )
+        {
+            if( ! arg.isOption() )
+                file = arg.resolveAsFile();
+        }
+
+        if( file == juce::File() )
+        {
+            std::cerr << "usage: GraphRunner [file.filtergraph] [--generate=N] [--serial] [--threads=T]"
+                         " [--blocks=B] [--block-size=S] [--sample-rate=R] [--engine=biquad|svf]"
+                         " [--kernel=generic|avx2|avx512] [--automate] [--offline] [--trace=file.json]"
+                         " | --verify [--sample-rate=R] [--record=file.h] | --stress [--blocks=B] [--max-block-size=S] [--seed=N]"
+                         " [--params-per-block=P] [--budget-max-us=U] [--budget-p9999-us=U]"
+                         " | --channel-scaling [--channels=N] [--max-workers=W] [--blocks=B] [--block-size=S]"
+                         " [--sample-rate=R] | --cc-scaling [--blocks=B] [--block-size=S] [--sample-rate=R]"
+                         " | --editor-open [--editors=N] | --footprint [--instances=N]" << std::endl;
+            return 1;
+        }
+
+        auto result = graph.loadFromFile(file);
+
+        if( result.failed() )
+        {
+            std::cerr << result.getErrorMessage() << std::endl;
+            return 1;
+        }
+    }
+
+    auto engine = args.getValueForOption("--engine");
+    
+    if( engine.isNotEmpty() )
+        graph.setParameter(Parameters::getID(Parameters::FilterEngineChoice), engine.equalsIgnoreCase("svf") ? 1.f : 0.f);
+    
+    if( args.containsOption("--automate") )
+        graph.enableAutomation();
+    
+    //as if the host were bouncing, the instances run their offline tier
+    if( args.containsOption("--offline") )
+    {
+        for( auto& node : graph.nodes )
+        {
+            if( node->processor != nullptr )
+                node->processor->setNonRealtime(true);
+        }
+    }
+    
+    graph.prepare(sampleRate, blockSize);
+
+    CacheCounters cacheCounters;
+    GraphScheduler scheduler(graph, numThreads);
+
+    //let caches, the coefficient cache and the allocator settle before we measure
+    for( int i = 0; i < 50; ++i )
+        scheduler.processBlock();
+
+    for( auto& node : graph.nodes )
+    {
+        node->totalSeconds = node->maxSeconds = 0;
+        node->blockSeconds.clear();
+        node->blockSeconds.reserve((size_t) numBlocks);
+    }
+
+    std::vector<double> blockSeconds;
+    blockSeconds.reserve((size_t) numBlocks);
+
+    for( int worker = 0; worker < scheduler.getNumWorkers(); ++worker )
+        scheduler.resetStats(worker);
+
+    cacheCounters.start();
+    auto start = juce::Time::getHighResolutionTicks();
+
+    for( int i = 0; i < numBlocks; ++i )
+    {
+        auto blockStart = juce::Time::getHighResolutionTicks();
+        scheduler.processBlock();
+        blockSeconds.push_back(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - blockStart));
+    }
+
+    cacheCounters.stop();
+    auto wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+    auto blockDuration = blockSize / sampleRate;
+    auto audioSeconds = numBlocks * blockDuration;
+    auto numInstances = graph.getNumInstances();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    std::cout << "nodes " << graph.nodes.size() << ", SimpleEq instances " << numInstances
+              << ", threads " << scheduler.getNumWorkers()
+              << ", block " << blockSize << " @ " << sampleRate << " Hz"
+              << ", engine " << (engine.isNotEmpty() ? engine : juce::String("biquad"))
+              << ", kernel " << FilterKernels::getName(FilterKernels::getSelectedVariant(AccuracyGate::isKernelEnabled))
+              << (args.containsOption("--automate") ? ", automated" : "")
+              << (args.containsOption("--offline") ? ", offline" : "") << std::endl;
+
+    std::cout << "realtime factor      " << audioSeconds / wallSeconds << "x" << std::endl;
+    std::cout << "instance throughput  " << numInstances * audioSeconds / wallSeconds << " instance-seconds / s" << std::endl;
+
+    std::cout << "graph block time     mean " << 1000.0 * wallSeconds / numBlocks
+              << " ms, p99 " << 1000.0 * percentile(blockSeconds, 0.99)
+              << " ms, max " << 1000.0 * percentile(blockSeconds, 1.0)
+              << " ms (budget " << 1000.0 * blockDuration << " ms)" << std::endl;
+
+    //dsp load of each instance: its share of the real time it was given
+    std::vector<double> loads;
+    const GraphNode* heaviest = nullptr;
+
+    for( auto& node : graph.nodes )
+    {
+        if( node->processor == nullptr )
+            continue;
+
+        loads.push_back(100.0 * node->totalSeconds / audioSeconds);
+
+        if( heaviest == nullptr || node->totalSeconds > heaviest->totalSeconds )
+            heaviest = node.get();
+    }
+
+    if( ! loads.empty() )
+    {
+        std::cout << "instance dsp load %  min " << percentile(loads, 0.0)
+                  << ", median " << percentile(loads, 0.5)
+                  << ", p90 " << percentile(loads, 0.9)
+                  << ", max " << percentile(loads, 1.0) << std::endl;
+
+        std::cout << "heaviest instance    " << heaviest->name << " (uid " << heaviest->uid << "), worst block "
+                  << 1000.0 * heaviest->maxSeconds << " ms, p99 "
+                  << 1000.0 * percentile(heaviest->blockSeconds, 0.99) << " ms" << std::endl;
+    }
+
+    //the noise sources and mixers are in these too, compare runs of the same graph
+    if( cacheCounters.isAvailable(CacheCounters::Misses) )
+    {
+        auto instanceBlocks = (double) numBlocks * juce::jmax(1, numInstances);
+        auto misses = (double) cacheCounters.read(CacheCounters::Misses);
+        auto references = (double) cacheCounters.read(CacheCounters::References);
+
+        std::cout << "cache misses         " << misses / instanceBlocks << " per instance block";
+
+        if( references > 0.0 )
+            std::cout << ", " << 100.0 * misses / references << " % of references";
+
+        std::cout << std::endl;
+
+        if( cacheCounters.isAvailable(CacheCounters::L1dReadMisses) )
+            std::cout << "L1d read misses      " << (double) cacheCounters.read(CacheCounters::L1dReadMisses) / instanceBlocks
+                      << " per instance block" << std::endl;
+    }
+    else
+    {
+        std::cout << "cache misses         unavailable (perf_event_open refused, check perf_event_paranoid)" << std::endl;
+    }
+
+    for( int worker = 0; worker < scheduler.getNumWorkers(); ++worker )
+    {
+        std::cout << "worker " << worker << "             busy " << 100.0 * scheduler.getBusySeconds(worker) / wallSeconds
+                  << " %, steals " << scheduler.getNumSteals(worker) << std::endl;
+    }
+
+    benchmarkKernels(blockSize, sampleRate);
+
+    return 0;
+}
@@ -0,0 +1,253 @@
+/*
+  ==============================================================================
+
+    StressTest.cpp
+    One SimpleEq driven the way a badly behaved host would.
+
+  ==============================================================================
+*/
+
+#include "StressTest.h"
+#include "GraphRunner.h"
+#include "../../../Source/PluginProcessor.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+static constexpr double sampleRates[] = { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+
+//the input peaks at -6 dBFS (0.5), anything 40 dB over that is a filter running away
+static constexpr float blowUpLevel = 50.f;
+
+struct OutputCheck
+{
+    juce::int64 numNaNs { 0 }, numInfinities { 0 }, numDenormals { 0 }, numBlowUps { 0 };
+    float peak { 0.f };
+    int firstBadBlock { -1 };
+
+    bool hasFailed() const { return numNaNs + numInfinities + numDenormals + numBlowUps > 0; }
+
+    void check(const juce::AudioBuffer<float>& buffer, int block)
+    {
+        auto failedBefore = hasFailed();
+
+        for( int channel = 0; channel < buffer.getNumChannels(); ++channel )
+        {
+            auto* samples = buffer.getReadPointer(channel);
+
+            for( int i = 0; i < buffer.getNumSamples(); ++i )
+            {
+                auto x = samples[i];
+
+                if( std::isnan(x) )
+                    ++numNaNs;
+                else if( std::isinf(x) )
+                    ++numInfinities;
+                else if( std::fpclassify(x) == FP_SUBNORMAL )
+                    ++numDenormals;
+                else if( std::abs(x) > blowUpLevel )
+                    ++numBlowUps;
+                else
+                    peak = juce::jmax(peak, std::abs(x));
+            }
+        }
+
+        if( hasFailed() && ! failedBefore )
+            firstBadBlock = block;
+    }
+};
+
+//mostly ordinary sizes, a lot of tiny ones, now and then nothing at all
+static int pickBlockSize(juce::Random& random, int maxBlockSize)
+{
+    auto choice = random.nextInt(100);
+
+    if( choice < 2 )
+        return 0;
+    if( choice < 20 )
+        return 1;
+    if( choice < 40 )
+        return 1 + random.nextInt(juce::jmin(32, maxBlockSize));
+
+    return 1 + random.nextInt(maxBlockSize);
+}
+
+//saved from a scratch instance with every parameter (modes, engines, slopes included) randomised
+static std::vector<juce::MemoryBlock> makeStates(juce::Random& random, int numStates)
+{
+    SimpleEqAudioProcessor scratch;
+    std::vector<juce::MemoryBlock> states((size_t) numStates);
+
+    for( auto& state : states )
+    {
+        for( auto* parameter : scratch.getParameters() )
+            parameter->setValueNotifyingHost(random.nextFloat());
+
+        scratch.getStateInformation(state);
+    }
+
+    return states;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+int StressTest::run(const Options& options)
+{
+    juce::Random random(options.seed);
+    auto states = makeStates(random, 8);
+
+    SimpleEqAudioProcessor processor;
+    std::vector<juce::RangedAudioParameter*> parameters;
+
+    for( auto& descriptor : Parameters::descriptors )
+        parameters.push_back(processor.apvts.getParameter(descriptor.id));
+
+    auto maxBlockSize = juce::jmax(1, options.maxBlockSize);
+    std::vector<double> prepareMilliseconds;
+
+    auto prepare = [&](double sampleRate)
+    {
+        auto start = juce::Time::getHighResolutionTicks();
+        processor.setRateAndBufferSizeDetails(sampleRate, maxBlockSize);
+        processor.prepareToPlay(sampleRate, maxBlockSize);
+        prepareMilliseconds.push_back(1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+    };
+
+    prepare(48000.0);
+
+    //a session being reloaded (or an undo in the host) while the transport runs
+    std::atomic<bool> shouldStop { false };
+    std::atomic<int> numStateLoads { 0 };
+
+    std::thread stateThread([&]
+    {
+        juce::Random stateRandom(options.seed + 1);
+
+        while( ! shouldStop.load() )
+        {
+            auto& state = states[(size_t) stateRandom.nextInt((int) states.size())];
+            processor.setStateInformation(state.getData(), (int) state.getSize());
+            numStateLoads.fetch_add(1);
+
+            std::this_thread::sleep_for(std::chrono::microseconds(200 + stateRandom.nextInt(3000)));
+        }
+    });
+
+    juce::AudioBuffer<float> buffer(2, maxBlockSize);
+    juce::MidiBuffer midi;
+    OutputCheck output;
+    std::vector<double> blockMicroseconds;
+    blockMicroseconds.reserve((size_t) options.numBlocks);
+
+    juce::int64 numSamplesProcessed = 0;
+    double worstMicroseconds = -1.0;
+    int worstBlockSize = 0;
+    int silentBlocksLeft = 0;
+    int numTierSwitches = 0;
+
+    for( int block = 0; block < options.numBlocks; ++block )
+    {
+        if( random.nextInt(2000) == 0 )
+            prepare(sampleRates[random.nextInt((int) std::size(sampleRates))]);
+
+        //hosts flip this around bounces, the filters have to carry on across it
+        if( random.nextInt(500) == 0 )
+        {
+            processor.setNonRealtime(! processor.isNonRealtime());
+            ++numTierSwitches;
+        }
+
+        auto numSamples = pickBlockSize(random, maxBlockSize);
+        buffer.setSize(2, numSamples, false, false, true);
+
+        for( int p = 0; p < options.parametersPerBlock; ++p )
+            parameters[(size_t) random.nextInt((int) parameters.size())]->setValueNotifyingHost(random.nextFloat());
+
+        //silence now and then, so the tails run out and the idle path gets used
+        if( silentBlocksLeft > 0 )
+        {
+            --silentBlocksLeft;
+            buffer.clear();
+        }
+        else
+        {
+            if( random.nextInt(500) == 0 )
+                silentBlocksLeft = random.nextInt(400);
+
+            for( int channel = 0; channel < 2; ++channel )
+            {
+                auto* samples = buffer.getWritePointer(channel);
+
+                for( int i = 0; i < numSamples; ++i )
+                    samples[i] = random.nextFloat() - 0.5f;
+            }
+        }
+
+        auto start = juce::Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midi);
+        auto microseconds = 1.0e6 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+        //the budgets are for live playback, offline blocks are allowed to take longer
+        if( ! processor.isNonRealtime() )
+        {
+            if( microseconds > worstMicroseconds )
+            {
+                worstMicroseconds = microseconds;
+                worstBlockSize = numSamples;
+            }
+
+            blockMicroseconds.push_back(microseconds);
+        }
+
+        numSamplesProcessed += numSamples;
+        output.check(buffer, block);
+    }
+
+    shouldStop.store(true);
+    stateThread.join();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    auto mean = std::accumulate(blockMicroseconds.begin(), blockMicroseconds.end(), 0.0) / juce::jmax((size_t) 1, blockMicroseconds.size());
+    auto p9999 = percentile(blockMicroseconds, 0.9999);
+    auto worst = juce::jmax(0.0, worstMicroseconds);
+
+    std::cout << "stress: " << options.numBlocks << " blocks, " << numSamplesProcessed << " samples, seed " << options.seed
+              << ", " << options.parametersPerBlock << " parameter changes per block" << std::endl;
+
+    std::cout << "state loads          " << numStateLoads.load() << " from another thread" << std::endl;
+    std::cout << "tier switches        " << numTierSwitches << " realtime <-> offline" << std::endl;
+
+    //the first prepare at a new rate also runs the accuracy gate
+    std::cout << "prepareToPlay        " << prepareMilliseconds.size() << " calls, max "
+              << percentile(prepareMilliseconds, 1.0) << " ms" << std::endl;
+
+    std::cout << "block time us        mean " << mean
+              << ", p50 " << percentile(blockMicroseconds, 0.5)
+              << ", p99 " << percentile(blockMicroseconds, 0.99)
+              << ", p99.9 " << percentile(blockMicroseconds, 0.999)
+              << ", p99.99 " << p9999
+              << ", max " << worst << " (" << worstBlockSize << " samples)" << std::endl;
+
+    std::cout << "output               peak " << juce::Decibels::gainToDecibels(output.peak) << " dBFS, NaNs " << output.numNaNs
+              << ", infinities " << output.numInfinities << ", denormals " << output.numDenormals
+              << ", over " << juce::Decibels::gainToDecibels(blowUpLevel) << " dBFS " << output.numBlowUps << std::endl;
+
+    bool passed = true;
+
+    if( output.hasFailed() )
+    {
+        std::cout << "FAIL: bad output, first in block " << output.firstBadBlock << std::endl;
+        passed = false;
+    }
+
+    if( options.maxBlockMicroseconds > 0 && worst > options.maxBlockMicroseconds )
+    {
+        std::cout << "FAIL: worst block " << worst << " us, budget " << options.maxBlockMicroseconds << " us" << std::endl;
+        passed = false;
+    }
+
+    if( options.p9999BlockMicroseconds > 0 && p9999 > options.p9999BlockMicroseconds )
+    {
+        std::cout << "FAIL: p99.99 block " << p9999 << " us, budget " << options.p9999BlockMicroseconds << " us" << std::endl;
+        passed = false;
+    }
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    StressTest.h
+    One SimpleEq driven the way a badly behaved host would.
+
+    Random block sizes down to single samples (and the odd empty block),
+    prepareToPlay at a new sample rate in the middle of the stream,
+    setStateInformation from another thread, a handful of parameter changes
+    every block, stretches of silence and switches in and out of offline
+    rendering. Every block is timed and its output
+    checked for NaNs, infinities, denormals and runaway levels.
+
+    GraphRunner --stress [--blocks=B] [--max-block-size=S] [--seed=N]
+                         [--params-per-block=P] [--budget-max-us=U] [--budget-p9999-us=U]
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+struct StressTest
+{
+    struct Options
+    {
+        int numBlocks { 20000 };
+        int maxBlockSize { 1024 };
+        int parametersPerBlock { 4 };
+        juce::int64 seed { 1 };
+
+        //0 leaves the budget unchecked
+        double maxBlockMicroseconds { 0 };
+        double p9999BlockMicroseconds { 0 };
+    };
+
+    //prints the report, returns the process exit code: 0 if nothing failed
+    static int run(const Options& options);
+};